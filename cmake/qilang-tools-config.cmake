@@ -112,6 +112,7 @@ function(qi_gen_idl output lang pkg dir)
             -o "${generated_path}"
             -t "${sdk_dir}"
             ${import_dirs}
+            ${ARG_FLAGS}
         DEPENDS
           qilang::qicc
           "${abs_idl_path}"
@@ -135,6 +136,7 @@ function(qi_gen_idl output lang pkg dir)
             -o "${generated_path}"
             -t "${sdk_dir}"
             ${import_dirs}
+            ${ARG_FLAGS}
         DEPENDS
           qilang::qicc
           "${abs_idl_path}"
@@ -158,6 +160,7 @@ function(qi_gen_idl output lang pkg dir)
             -o "${generated_path}"
             -t "${sdk_dir}"
             ${import_dirs}
+            ${ARG_FLAGS}
         DEPENDS
           qilang::qicc
           "${abs_idl_path}"
@@ -181,6 +184,7 @@ function(qi_gen_idl output lang pkg dir)
             -o "${generated_path}"
             -t "${sdk_dir}"
             ${import_dirs}
+            ${ARG_FLAGS}
         DEPENDS
           qilang::qicc
           "${abs_idl_path}"
@@ -219,6 +223,7 @@ Generate source files and create a shared library out of them.
     [API_HEADER <api_header>]
     [DEPENDS <deps>...]
     [IMPORT_DIRS <import_dirs>...]
+    [FLAGS <flags>...]
   )
 
 - ``<pkg>``: The package name, also the name of the resulting target.
@@ -227,6 +232,7 @@ Generate source files and create a shared library out of them.
   start with "share/qi/idl/".
 - ``DEPENDS``: the list of dependencies required by the generated library.
 - ``IMPORT_DIRS``: list of directories to be searched for imported packages.
+- ``FLAGS``: list of flags to pass to ``qicc``.
 - ``API_HEADER``: the path to a "api" header, if any. If none is given, it
   will default to ``<pkg>/api.hpp``.
 - ``NO_INSTALL``: do not generate install rule.
@@ -241,7 +247,7 @@ function(qi_gen_lib pkg dir)
     ARG
     "NO_INSTALL"
     "API_HEADER"
-    "DEPENDS;IDL;IMPORT_DIRS"
+    "DEPENDS;IDL;IMPORT_DIRS;FLAGS"
     ${ARGN}
   )
 
@@ -257,6 +263,11 @@ function(qi_gen_lib pkg dir)
     set(maybe_import_dirs IMPORT_DIRS ${ARG_IMPORT_DIRS})
   endif()
 
+  set(maybe_flags)
+  if(DEFINED ARG_FLAGS)
+    set(maybe_flags FLAGS ${ARG_FLAGS})
+  endif()
+
   qi_gen_idl(
     generated
     CPP
@@ -265,6 +276,7 @@ function(qi_gen_lib pkg dir)
     ${idl_files}
     ${maybe_no_install}
     ${maybe_import_dirs}
+    ${maybe_flags}
   )
 
   if(NOT ARG_API_HEADER)
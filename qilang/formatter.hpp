@@ -50,11 +50,40 @@ namespace qilang {
   inline FileWriterPtr newFileWriter(const std::string& fname) { return boost::make_shared<FileWriter>(fname); }
   inline FileWriterPtr newFileWriter(std::ostream* o, const std::string& fname) { return boost::make_shared<FileWriter>(o, fname); }
 
-  QILANG_API std::string genCppObjectInterface(const PackageManagerPtr& pm, const ParseResultPtr& nodes);
+  /// Options of the C++ code generators, set from the command line of qicc.
+  struct QILANG_API CodegenOptions {
+    CodegenOptions()
+      : specializedStructs(false)
+      , reorderStructFields(false)
+      , instrument(false)
+      , trace(false)
+      , probes(false)
+    {}
+
+    /// Register structs with a generated `qi::StructTypeInterface` instead of `QI_TYPE_STRUCT`.
+    bool specializedStructs;
+    /// Store the members of structs by decreasing alignment to minimize padding.
+    /// Registration and serialization keep the declaration order, but aggregate initialization
+    /// follows the storage order.
+    bool reorderStructFields;
+    /// Count the calls, errors and latencies of the methods of local bindings and remote proxies.
+    bool instrument;
+    /// Record a span of each call of the methods of local bindings and remote proxies, which
+    /// `qilang::detail::writeChromeTrace` dumps.
+    bool trace;
+    /// Fire USDT probes at the entry and the exit of the calls of the methods of local bindings and
+    /// remote proxies, where `sys/sdt.h` is available.
+    bool probes;
+  };
 
-  QILANG_API std::string genCppObjectRemote(const PackageManagerPtr& pm, const ParseResultPtr& nodes);
+  QILANG_API std::string genCppObjectInterface(const PackageManagerPtr& pm, const ParseResultPtr& nodes,
+                                               const CodegenOptions& options = CodegenOptions());
 
-  QILANG_API std::string genCppObjectLocal(const PackageManagerPtr& pm, const ParseResultPtr& nodes);
+  QILANG_API std::string genCppObjectRemote(const PackageManagerPtr& pm, const ParseResultPtr& nodes,
+                                            const CodegenOptions& options = CodegenOptions());
+
+  QILANG_API std::string genCppObjectLocal(const PackageManagerPtr& pm, const ParseResultPtr& nodes,
+                                           const CodegenOptions& options = CodegenOptions());
   QILANG_API std::string genCppGMock(const PackageManagerPtr& pm, const ParseResultPtr& nodes);
 
   QILANG_API std::string formatAST(const NodePtrVector& node);
@@ -63,6 +92,9 @@ namespace qilang {
   QILANG_API std::string formatAST(const NodePtr& node);
   QILANG_API std::string format(const NodePtr& node);
 
+  QILANG_API std::string genLayoutReport(const PackageManagerPtr& pm, const ParseResultPtr& pr,
+                                         const CodegenOptions& options = CodegenOptions());
+
   QILANG_API std::string genDoc(const NodePtr& node);
   QILANG_API std::string genDoc(const NodePtrVector& node);
 
@@ -73,7 +105,8 @@ namespace qilang {
       const FileWriterPtr& out,
       const std::string& generator,
       const PackageManagerPtr& pm,
-      const ParseResultPtr& pr);
+      const ParseResultPtr& pr,
+      const CodegenOptions& options = CodegenOptions());
 
   enum FormatterCodeGen {
     QiLang,
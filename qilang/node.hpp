@@ -87,6 +87,8 @@ class ListTypeExprNode;
 class MapTypeExprNode;
 class TupleTypeExprNode;
 class OptionalTypeExprNode;
+class ArrayTypeExprNode;
+class StreamTypeExprNode;
 
 // EXPR
 class ExprNode;        //VIRTUAL: dep on TypeExpr, Literal
@@ -214,6 +216,8 @@ public:
   virtual void visitTypeExpr(MapTypeExprNode* node) = 0;
   virtual void visitTypeExpr(TupleTypeExprNode* node) = 0;
   virtual void visitTypeExpr(OptionalTypeExprNode* node) = 0;
+  virtual void visitTypeExpr(ArrayTypeExprNode* node) = 0;
+  virtual void visitTypeExpr(StreamTypeExprNode* node) = 0;
   virtual void visitTypeExpr(VarArgTypeExprNode *node) = 0;
   virtual void visitTypeExpr(KeywordArgTypeExprNode *node) = 0;
 };
@@ -244,6 +248,8 @@ enum NodeType {
   NodeType_ListTypeExpr,
   NodeType_TupleTypeExpr,
   NodeType_OptionalTypeExpr,
+  NodeType_ArrayTypeExpr,
+  NodeType_StreamTypeExpr,
 
   NodeType_BoolData,
   NodeType_IntData,
@@ -312,7 +318,8 @@ typedef boost::shared_ptr<KeywordNode> KeywordNodePtr;
 
 enum UnaryOpCode {
   UnaryOpCode_Negate,
-  UnaryOpCode_Minus
+  UnaryOpCode_Minus,
+  UnaryOpCode_Complement
 };
 
 enum BinaryOpCode {
@@ -456,14 +463,22 @@ public:
 
 class QILANG_API IntLiteralNode: public LiteralNode {
 public:
-  explicit IntLiteralNode(qi::uint64_t val, const Location& loc)
+  explicit IntLiteralNode(qi::uint64_t val, const Location& loc, bool negative = false)
     : LiteralNode(NodeType_IntData, loc)
     , value(val)
+    , _negative(negative)
   {}
 
   void accept(NodeVisitor* visitor) { visitor->visitData(this); }
 
+  /// Negative values, only produced by constant expressions, are stored in two's complement.
+  /// The sign is not guessed from `value`: literals above the max of qi::int64_t are positive.
+  bool negative() const { return _negative; }
+
   qi::uint64_t value;
+
+private:
+  bool _negative;
 };
 
 class QILANG_API FloatLiteralNode: public LiteralNode {
@@ -573,6 +588,7 @@ enum BuiltinType {
 
   BuiltinType_String,
   BuiltinType_Raw,
+  BuiltinType_RawView,      //immutable refcounted buffer, same signature as raw
   BuiltinType_Value,
   BuiltinType_Object,
 };
@@ -605,6 +621,7 @@ public:
   std::string resolved_package;
   std::string resolved_value;
   TypeKind resolved_kind;
+  TypeExprNodePtr resolved_underlying_type; // of an enum, null for the default (int)
   std::string value;
 };
 
@@ -701,6 +718,34 @@ public:
   TypeExprNodePtr element;
 };
 
+/// A fixed number of elements stored inline: `Array<T, N>`.
+class QILANG_API ArrayTypeExprNode : public TypeExprNode {
+public:
+  explicit ArrayTypeExprNode(const TypeExprNodePtr& element, qi::uint64_t size, const Location& loc)
+    : TypeExprNode(NodeType_ArrayTypeExpr, loc)
+    , element(element)
+    , size(size)
+  {}
+
+  void accept(NodeVisitor* visitor) { visitor->visitTypeExpr(this); }
+
+  TypeExprNodePtr element;
+  qi::uint64_t    size;
+};
+
+/// A flow of elements read by chunks, with backpressure: `Stream<T>`.
+class QILANG_API StreamTypeExprNode : public TypeExprNode {
+public:
+  explicit StreamTypeExprNode(const TypeExprNodePtr& element, const Location& loc)
+    : TypeExprNode(NodeType_StreamTypeExpr, loc)
+    , element(element)
+  {}
+
+  void accept(NodeVisitor* visitor) { visitor->visitTypeExpr(this); }
+
+  TypeExprNodePtr element;
+};
+
 // ####################
 // # STMT Node
 // ####################
@@ -809,6 +854,28 @@ public:
 // # DECL Node
 // ####################
 
+/// Annotation attached to a declaration: `@name` or `@name(arg, ...)`.
+/// Annotations are not part of the AST itself, they only tune code generation.
+class QILANG_API Annotation {
+public:
+  Annotation()
+  {}
+  Annotation(const std::string& name, const Location& loc)
+    : name(name)
+    , loc(loc)
+  {}
+  Annotation(const std::string& name, const LiteralNodePtrVector& args, const Location& loc)
+    : name(name)
+    , args(args)
+    , loc(loc)
+  {}
+
+  std::string          name;
+  LiteralNodePtrVector args;
+  Location             loc;
+};
+typedef std::vector<Annotation> AnnotationVector;
+
 class QILANG_API DeclNode : public Node
 {
 public:
@@ -817,6 +884,21 @@ public:
   {}
 
   virtual void accept(NodeVisitor* visitor) = 0;
+
+  /// @return the annotation named `name` or 0 if the declaration does not have it.
+  const Annotation* annotation(const std::string& name) const {
+    for (unsigned i = 0; i < annotations.size(); ++i) {
+      if (annotations.at(i).name == name)
+        return &annotations.at(i);
+    }
+    return 0;
+  }
+
+  bool hasAnnotation(const std::string& name) const {
+    return annotation(name) != 0;
+  }
+
+  AnnotationVector annotations;
 };
 
 class QILANG_API TypeDefDeclNode : public DeclNode
@@ -865,12 +947,24 @@ public:
     : DeclNode(NodeType_EnumDecl, loc)
     , name(name)
     , fields(fields)
+    , flags(false)
+  {}
+
+  /// @param underlyingType Must be an integral BuiltinTypeExprNode
+  EnumDeclNode(const std::string &name, const TypeExprNodePtr& underlyingType, const EnumFieldDeclNodePtrVector& fields, const Location& loc)
+    : DeclNode(NodeType_EnumDecl, loc)
+    , name(name)
+    , underlyingType(underlyingType)
+    , fields(fields)
+    , flags(false)
   {}
 
   void accept(NodeVisitor* visitor) { visitor->visitDecl(this); }
 
   std::string                name;
+  TypeExprNodePtr            underlyingType; // null for the default (int)
   EnumFieldDeclNodePtrVector fields;
+  bool                       flags;          // declared with `flags`: one bit per field
 };
 
 
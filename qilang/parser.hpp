@@ -113,6 +113,18 @@ namespace qilang {
 
   QILANG_API ParseResultPtr parse(const FileReaderPtr& filename);
   QILANG_API TypeExprNodePtr signatureToQiLang(const qi::Signature& sig);
+  /// Inverse of signatureToQiLang, for the types whose signature is known at generation time.
+  /// @return false if the signature of `type` depends on the C++ registration (structs, time types, ...)
+  QILANG_API bool qiLangToSignature(const TypeExprNodePtr& type, std::string& signature);
+  /// Folds a constant expression of literals and operators into a literal.
+  /// @throw std::runtime_error if an operator does not accept its operands
+  QILANG_API LiteralNodePtr evalConstExpr(const ExprNodePtr& expr);
+  /// @return why `value` cannot initialize a constant of type `type`, or an empty string if it can
+  QILANG_API std::string checkConstType(const TypeExprNodePtr& type, const LiteralNodePtr& value);
+  /// Type of an untyped constant: the narrowest of int and int64 for ints, float64, str, and
+  /// containers of those.
+  /// @return null if the values of a container do not share a type (or if it is empty)
+  QILANG_API TypeExprNodePtr inferConstType(const LiteralNodePtr& value);
   QILANG_API NodePtr metaObjectToQiLang(const std::string& name, const qi::MetaObject& obj);
 
   /* parse options:
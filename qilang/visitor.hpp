@@ -100,6 +100,12 @@ namespace qilang {
     void visitTypeExpr(OptionalTypeExprNode *node) {
       acceptWithCb(node->element);
     }
+    void visitTypeExpr(ArrayTypeExprNode *node) {
+      acceptWithCb(node->element);
+    }
+    void visitTypeExpr(StreamTypeExprNode *node) {
+      acceptWithCb(node->element);
+    }
     void visitTypeExpr(VarArgTypeExprNode *node) {
       acceptWithCb(node->element);
     }
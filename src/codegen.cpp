@@ -17,12 +17,13 @@ namespace qilang {
       const FileWriterPtr&             out,
       const std::string&               generator,
       const qilang::PackageManagerPtr& pm,
-      const qilang::ParseResultPtr&    pr)
+      const qilang::ParseResultPtr&    pr,
+      const CodegenOptions&            options)
   {
     static const char* vals[] = { "cpp_interface", "cppi",
                                   "cpp_local", "cppl",
                                   "cpp_remote", "cppr",
-                                  "cpp_gmock",
+                                  "cpp_gmock", "layout_report",
                                   "sexpr", "qilang", "doc", 0 };
     int index = 0;
     const char* v = vals[index];
@@ -55,13 +56,15 @@ namespace qilang {
       return false;
     }
     if      (generator == "cpp_interface" || generator == "cppi")
-      out->out() << qilang::genCppObjectInterface(pm, pr);
+      out->out() << qilang::genCppObjectInterface(pm, pr, options);
     else if (generator == "cpp_local"     || generator == "cppl")
-      out->out() << qilang::genCppObjectLocal(pm, pr);
+      out->out() << qilang::genCppObjectLocal(pm, pr, options);
     else if (generator == "cpp_remote"    || generator == "cppr")
-      out->out() << qilang::genCppObjectRemote(pm, pr);
+      out->out() << qilang::genCppObjectRemote(pm, pr, options);
     else if (generator == "cpp_gmock")
       out->out() << qilang::genCppGMock(pm, pr);
+    else if (generator == "layout_report")
+      out->out() << qilang::genLayoutReport(pm, pr, options);
     return true;
   }
 
@@ -4,12 +4,18 @@
 **
 ** Copyright (C) 2014 Cedric GESTES
 */
+#include <algorithm>
+#include <cctype>
+#include <map>
+#include <set>
 #include <sstream>
 #include "formatter_p.hpp"
+#include "cpptype.hpp"
 #include <boost/algorithm/string.hpp>
 #include <qilang/visitor.hpp>
 #include <qi/path.hpp>
 #include <qilang/packagemanager.hpp>
+#include <qilang/parser.hpp>
 
 qiLogCategory("qilang.cpp");
 
@@ -79,6 +85,8 @@ std::string builtinTypeToCpp(BuiltinType type, bool constref) {
       return constRefYourSelf("std::string", constref);
     case BuiltinType_Raw:
       return constRefYourSelf("qi::Buffer", constref);
+    case BuiltinType_RawView:
+      return constRefYourSelf("qilang::SharedBuffer", constref);
     case BuiltinType_Value:
       return constRefYourSelf("qi::AnyValue", constref);
     case BuiltinType_Object:
@@ -245,7 +253,7 @@ StringVector extractCppIncludeDir(const PackageManagerPtr& pm, const ParseResult
       case NodeType_TupleTypeExpr: {
         TupleTypeExprNode* tnode = static_cast<TupleTypeExprNode*>(node.get());
         if (tnode->elements.size() == 2)
-          pushIfNot(includes, "<pair>");
+          pushIfNot(includes, "<utility>");
         else {
           pushIfNot(includes, "NOTIMPLTUPLE");
           qiLogWarning() << "BUG: include handling for tuple with size != 2 not handled";
@@ -258,11 +266,18 @@ StringVector extractCppIncludeDir(const PackageManagerPtr& pm, const ParseResult
       case NodeType_MapTypeExpr:
         pushIfNot(includes, "<map>");
         break;
+      case NodeType_ArrayTypeExpr:
+        pushIfNot(includes, "<array>");
+        break;
+      case NodeType_StreamTypeExpr:
+        pushIfNot(includes, "<vector>");
+        pushIfNot(includes, "<qi/anyobject.hpp>");
+        break;
       case NodeType_BuiltinTypeExpr: {
         BuiltinTypeExprNode* tnode = static_cast<BuiltinTypeExprNode*>(node.get());
         if (tnode->value == "str") {
           pushIfNot(includes, "<string>");
-        } else if (tnode->value == "raw") {
+        } else if (tnode->value == "raw" || tnode->value == "rawview") {
           pushIfNot(includes, "<qi/buffer.hpp>");
         } else if (tnode->value == "any") {
           pushIfNot(includes, "<qi/anyvalue.hpp>");
@@ -316,10 +331,25 @@ StringVector extractCppIncludeDir(const PackageManagerPtr& pm, const ParseResult
         pushIfNot(includes, "<qi/type/proxyproperty.hpp>");
         break;
       case NodeType_StructDecl:
+        if (static_cast<StructDeclNode*>(node.get())->hasAnnotation("columnsof"))
+          pushIfNot(includes, "<stdexcept>");
+        pushIfNot(includes, "<qi/anyobject.hpp>");
+        break;
       case NodeType_InterfaceDecl:
         pushIfNot(includes, "<qi/anyobject.hpp>");
         break;
+      case NodeType_ConstDecl: {
+        const TypeExprNodePtr type = cppConstType(static_cast<ConstDeclNode*>(node.get()));
+        if (isConstexprType(type) && type->type() == NodeType_ListTypeExpr)
+          pushIfNot(includes, "<array>");
+        break;
+      }
       case NodeType_EnumDecl:
+        if (static_cast<EnumDeclNode*>(node.get())->underlyingType)
+          pushIfNot(includes, "<type_traits>");
+        pushIfNot(includes, "<cstddef>");
+        pushIfNot(includes, "<string_view>");
+        pushIfNot(includes, "<utility>");
         pushIfNot(includes, "<qi/type/typeinterface.hpp>");
         break;
       default:
@@ -329,5 +359,361 @@ StringVector extractCppIncludeDir(const PackageManagerPtr& pm, const ParseResult
   return includes;
 }
 
+TypeExprNodePtr cppConstType(ConstDeclNode* node) {
+  TypeExprNodePtr type = node->type;
+  if (!type && node->data)
+    type = inferConstType(node->data);
+  if (!type)
+    type = node->effectiveType();
+  return type;
+}
+
+static bool isConstexprScalar(const TypeExprNodePtr& type) {
+  if (type->type() != NodeType_BuiltinTypeExpr)
+    return false;
+  const BuiltinType builtin = static_cast<BuiltinTypeExprNode*>(type.get())->builtinType;
+  return (builtin >= BuiltinType_Bool && builtin <= BuiltinType_Float64) || builtin == BuiltinType_String;
+}
+
+bool isConstexprType(const TypeExprNodePtr& type) {
+  switch (type->type()) {
+    case NodeType_ListTypeExpr:
+      return isConstexprScalar(static_cast<ListTypeExprNode*>(type.get())->element);
+    case NodeType_ArrayTypeExpr:
+      return isConstexprScalar(static_cast<ArrayTypeExprNode*>(type.get())->element);
+    default:
+      return isConstexprScalar(type);
+  }
+}
+
+bool cppBatchOptions(const FnDeclNode* node, CppBatchOptions& options) {
+  const Annotation* batch = node->annotation("batch");
+  if (!batch)
+    return false;
+  CppBatchOptions result = {5, 64};
+  // the grammar only accepts non-negative integers
+  if (batch->args.size() > 0)
+    result.windowMs = static_cast<IntLiteralNode*>(batch->args.at(0).get())->value;
+  if (batch->args.size() > 1)
+    result.maxCount = static_cast<IntLiteralNode*>(batch->args.at(1).get())->value;
+  options = result;
+  return true;
+}
+
+bool cppCacheOptions(const FnDeclNode* node, CppCacheOptions& options) {
+  if (node->hasAnnotation("pure")) {
+    options.ttlMs = 0;
+    options.invalidatedBy.clear();
+    return true;
+  }
+  const Annotation* cached = node->annotation("cached");
+  if (!cached)
+    return false;
+  // checked by the grammar: a positive duration then an optional signal name
+  options.ttlMs = static_cast<IntLiteralNode*>(cached->args.at(0).get())->value;
+  options.invalidatedBy.clear();
+  if (cached->args.size() > 1)
+    options.invalidatedBy = static_cast<StringLiteralNode*>(cached->args.at(1).get())->value;
+  return true;
+}
+
+bool cppTimeout(const FnDeclNode* node, qi::uint64_t& timeoutMs) {
+  const Annotation* timeout = node->annotation("timeout");
+  if (!timeout)
+    return false;
+  // checked by the grammar: a positive integer
+  timeoutMs = static_cast<IntLiteralNode*>(timeout->args.at(0).get())->value;
+  return true;
+}
+
+StringVector cppTimeoutMethodNames(const InterfaceDeclNode* node) {
+  StringVector names;
+  for (unsigned int i = 0; i < node->values.size(); ++i) {
+    if (node->values.at(i)->type() != NodeType_FnDecl)
+      continue;
+    const FnDeclNode* fn = static_cast<FnDeclNode*>(node->values.at(i).get());
+    if (fn->hasAnnotation("timeout") && std::find(names.begin(), names.end(), fn->name) == names.end())
+      names.push_back(fn->name);
+  }
+  return names;
+}
+
+bool hasAnnotatedMembers(const NodePtrVector& nodes, const std::string& annotation) {
+  NodePtrVector decls = findNode(nodes, NodeKind_Decl);
+  for (unsigned i = 0; i < decls.size(); ++i) {
+    if (static_cast<DeclNode*>(decls.at(i).get())->hasAnnotation(annotation))
+      return true;
+  }
+  return false;
+}
+
+bool cppCoalescePeriod(const SigDeclNode* node, qi::uint64_t& periodMs) {
+  const Annotation* coalesce = node->annotation("coalesce");
+  if (!coalesce)
+    return false;
+  // checked by the grammar: a positive integer
+  periodMs = static_cast<IntLiteralNode*>(coalesce->args.at(0).get())->value;
+  return true;
+}
+
+bool cppDeadband(const PropDeclNode* node, double& band) {
+  const Annotation* deadband = node->annotation("deadband");
+  if (!deadband)
+    return false;
+  // checked by the grammar: a non-negative integer or float
+  const LiteralNodePtr& arg = deadband->args.at(0);
+  if (arg->type() == NodeType_FloatData)
+    band = static_cast<FloatLiteralNode*>(arg.get())->value;
+  else
+    band = static_cast<double>(static_cast<IntLiteralNode*>(arg.get())->value);
+  return true;
+}
+
+bool cppFilterableParameters(const SigDeclNode* node, StringVector& parameters) {
+  const Annotation* filterable = node->annotation("filterable");
+  if (!filterable)
+    return false;
+  parameters.clear();
+  // checked by the grammar: names of parameters of the signal
+  for (unsigned i = 0; i < node->args.size(); ++i) {
+    for (unsigned j = 0; j < node->args.at(i)->names.size(); ++j) {
+      const std::string& name = node->args.at(i)->names.at(j);
+      bool listed = false;
+      for (unsigned k = 0; k < filterable->args.size() && !listed; ++k)
+        listed = static_cast<StringLiteralNode*>(filterable->args.at(k).get())->value == name;
+      parameters.push_back(listed ? name : std::string());
+    }
+  }
+  return true;
+}
+
+std::string cppPrefixedName(const std::string& prefix, const std::string& name) {
+  std::string capitalized = name;
+  if (!capitalized.empty())
+    capitalized[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(capitalized[0])));
+  return prefix + capitalized;
+}
+
+std::string cppSignalFilterName(const std::string& iface, const SigDeclNode* node) {
+  return cppPrefixedName(iface, node->name) + "Filter";
+}
+
+StringVector cppMethodStatsNames(const InterfaceDeclNode* node) {
+  // any suffix is a valid identifier: the names of the overloads skip the ones already taken
+  std::set<std::string> taken;
+  for (unsigned int i = 0; i < node->values.size(); ++i) {
+    if (node->values.at(i)->type() == NodeType_FnDecl)
+      taken.insert(static_cast<FnDeclNode*>(node->values.at(i).get())->name);
+  }
+  StringVector names;
+  std::map<std::string, unsigned int> overloads;
+  for (unsigned int i = 0; i < node->values.size(); ++i) {
+    if (node->values.at(i)->type() != NodeType_FnDecl)
+      continue;
+    const std::string& name = static_cast<FnDeclNode*>(node->values.at(i).get())->name;
+    if (overloads[name]++ == 0) {
+      names.push_back(name);
+      continue;
+    }
+    std::string overload = name + std::to_string(overloads[name] - 1);
+    while (taken.count(overload))
+      overload += "_";
+    taken.insert(overload);
+    names.push_back(overload);
+  }
+  return names;
+}
+
+std::string cppMethodStatsAccessor(const std::string& iface) {
+  std::string accessor = iface + "Stats";
+  accessor[0] = static_cast<char>(std::tolower(static_cast<unsigned char>(accessor[0])));
+  return accessor;
+}
+
+StringVector cppCallWrappers(const CodegenOptions& options, const std::string& iface, const FnDeclNode* node,
+                             unsigned int method) {
+  StringVector wrappers;
+  if (options.probes) {
+    std::string arguments;
+    for (unsigned int i = 0; i < node->args.size(); ++i) {
+      for (unsigned int j = 0; j < node->args.at(i)->names.size(); ++j)
+        arguments += (arguments.empty() ? "" : ", ") + detail::toName(node->args.at(i)->names.at(j), i);
+    }
+    wrappers.push_back("::qilang::detail::probeCall(\"" + iface + "\", \"" + node->name
+                       + "\", ::qilang::detail::probeArgumentsSize(" + arguments + "), [&] {");
+  }
+  if (options.trace)
+    wrappers.push_back("::qilang::detail::traceCall(\"" + iface + "\", \"" + node->name + "\", [&] {");
+  // the calls of the generated class, named `_stats`
+  if (options.instrument)
+    wrappers.push_back("::qilang::detail::trackCall(_stats, " + std::to_string(method) + ", [&] {");
+  return wrappers;
+}
+
+bool cppMirrorsProperty(const PropDeclNode* node) {
+  return !node->hasAnnotation("uncached");
+}
+
+bool hasMirroredProperties(const NodePtrVector& nodes) {
+  NodePtrVector props = findNode(nodes, NodeType_PropDecl);
+  for (unsigned i = 0; i < props.size(); ++i) {
+    if (cppMirrorsProperty(static_cast<PropDeclNode*>(props.at(i).get())))
+      return true;
+  }
+  return false;
+}
+
+static std::size_t alignUp(std::size_t offset, std::size_t align) {
+  return (offset + align - 1) / align * align;
+}
+
+static CppLayout builtinTypeLayout(BuiltinType type) {
+  switch (type) {
+    case BuiltinType_Nothing:
+    case BuiltinType_Bool:
+    case BuiltinType_Char:
+    case BuiltinType_Int8:
+    case BuiltinType_UInt8:
+      return CppLayout{1, 1};
+    case BuiltinType_Int16:
+    case BuiltinType_UInt16:
+      return CppLayout{2, 2};
+    case BuiltinType_Int:
+    case BuiltinType_UInt:
+    case BuiltinType_Int32:
+    case BuiltinType_UInt32:
+    case BuiltinType_Float:
+    case BuiltinType_Float32:
+      return CppLayout{4, 4};
+    case BuiltinType_Int64:
+    case BuiltinType_UInt64:
+    case BuiltinType_Float64:
+    case BuiltinType_NanoSeconds:
+    case BuiltinType_MicroSeconds:
+    case BuiltinType_MilliSeconds:
+    case BuiltinType_Seconds:
+    case BuiltinType_Minutes:
+    case BuiltinType_Hours:
+    case BuiltinType_QiTimePoint:
+    case BuiltinType_SteadyTimePoint:
+    case BuiltinType_SystemTimePoint:
+      return CppLayout{8, 8};
+    case BuiltinType_String:
+      return CppLayout{32, 8};
+    // shared pointers
+    case BuiltinType_Raw:
+    case BuiltinType_RawView:
+    case BuiltinType_Object:
+      return CppLayout{16, 8};
+    case BuiltinType_Value:
+      return CppLayout{24, 8};
+  }
+  throw std::runtime_error("unreachable code");
+}
+
+// Layout of a struct whose members have the given layouts, in that order.
+static CppLayout aggregateLayout(const std::vector<CppLayout>& members, std::vector<std::size_t>* offsets = 0) {
+  std::size_t offset = 0;
+  std::size_t align = 1;
+  for (unsigned i = 0; i < members.size(); ++i) {
+    offset = alignUp(offset, members.at(i).align);
+    if (offsets)
+      offsets->push_back(offset);
+    offset += members.at(i).size;
+    align = std::max(align, members.at(i).align);
+  }
+  return CppLayout{std::max<std::size_t>(alignUp(offset, align), 1), align};
+}
+
+CppLayout cppTypeLayout(const PackageManagerPtr& pm, const TypeExprNodePtr& type, bool reorder) {
+  switch (type->type()) {
+    case NodeType_BuiltinTypeExpr:
+      return builtinTypeLayout(static_cast<BuiltinTypeExprNode*>(type.get())->builtinType);
+    case NodeType_CustomTypeExpr: {
+      CustomTypeExprNode* tnode = static_cast<CustomTypeExprNode*>(type.get());
+      if (tnode->resolved_kind == TypeKind_Enum) {
+        if (tnode->resolved_underlying_type)
+          return cppTypeLayout(pm, tnode->resolved_underlying_type, reorder);
+        return CppLayout{4, 4};
+      }
+      if (tnode->resolved_kind == TypeKind_Struct) {
+        PackagePtr pkg = pm->package(tnode->resolved_package);
+        NodePtr decl = pkg ? pkg->getExport(tnode->resolved_value) : NodePtr();
+        if (decl && decl->type() == NodeType_StructDecl) {
+          CppLayout layout;
+          cppStructLayout(pm, static_cast<StructDeclNode*>(decl.get()), reorder, layout);
+          return layout;
+        }
+        qiLogWarning() << "Unknown layout for struct " << tnode->value << ", assuming a pointer";
+        return CppLayout{8, 8};
+      }
+      // qi::Object<T>
+      return CppLayout{16, 8};
+    }
+    case NodeType_ListTypeExpr:
+      return CppLayout{24, 8};
+    case NodeType_MapTypeExpr:
+      return CppLayout{48, 8};
+    case NodeType_TupleTypeExpr: {
+      // std::pair<T1, T2> stores its members in declaration order. libstdc++'s std::tuple stores
+      // them in reverse order, each one in a base class whose tail padding the next one reuses:
+      // the layout is the one of a struct of the elements in reverse order.
+      TupleTypeExprNode* tnode = static_cast<TupleTypeExprNode*>(type.get());
+      std::vector<CppLayout> elements;
+      for (unsigned i = 0; i < tnode->elements.size(); ++i)
+        elements.push_back(cppTypeLayout(pm, tnode->elements.at(i), reorder));
+      if (elements.size() != 2)
+        std::reverse(elements.begin(), elements.end());
+      return aggregateLayout(elements);
+    }
+    case NodeType_OptionalTypeExpr: {
+      // boost::optional<T>: an initialization flag followed by the storage of T
+      std::vector<CppLayout> members;
+      members.push_back(CppLayout{1, 1});
+      members.push_back(cppTypeLayout(pm, static_cast<OptionalTypeExprNode*>(type.get())->element, reorder));
+      return aggregateLayout(members);
+    }
+    case NodeType_ArrayTypeExpr: {
+      ArrayTypeExprNode* tnode = static_cast<ArrayTypeExprNode*>(type.get());
+      const CppLayout element = cppTypeLayout(pm, tnode->element, reorder);
+      return CppLayout{element.size * tnode->size, element.align};
+    }
+    case NodeType_StreamTypeExpr:
+      // a qi::AnyObject
+      return builtinTypeLayout(BuiltinType_Object);
+    default:
+      throw std::runtime_error("varargs and kwargs have no layout");
+  }
+}
+
+CppStructMemberVector cppStructLayout(const PackageManagerPtr& pm, const StructDeclNode* node, bool reorder,
+                                      CppLayout& layout) {
+  CppStructMemberVector members;
+  for (unsigned i = 0; i < node->decls.size(); ++i) {
+    StructFieldDeclNodePtr field = boost::dynamic_pointer_cast<StructFieldDeclNode>(node->decls.at(i));
+    if (!field)
+      continue;
+    const CppLayout fieldLayout = cppTypeLayout(pm, field->effectiveType(), reorder);
+    for (unsigned j = 0; j < field->names.size(); ++j) {
+      CppStructMember member = {field->names.at(j), field, fieldLayout, 0};
+      members.push_back(member);
+    }
+  }
+
+  if (reorder) {
+    std::stable_sort(members.begin(), members.end(), [](const CppStructMember& lhs, const CppStructMember& rhs) {
+      return lhs.layout.align > rhs.layout.align;
+    });
+  }
+
+  std::vector<CppLayout> layouts;
+  for (unsigned i = 0; i < members.size(); ++i)
+    layouts.push_back(members.at(i).layout);
+  std::vector<std::size_t> offsets;
+  layout = aggregateLayout(layouts, &offsets);
+  for (unsigned i = 0; i < members.size(); ++i)
+    members.at(i).offset = offsets.at(i);
+  return members;
+}
 
 }
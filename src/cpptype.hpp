@@ -7,8 +7,10 @@
 #ifndef CPPTYPE_HPP
 #define CPPTYPE_HPP
 
+#include <limits>
 #include <string>
 #include <vector>
+#include <qilang/formatter.hpp>
 #include <qilang/node.hpp>
 #include <qilang/packagemanager.hpp>
 #include "formatter_p.hpp"
@@ -46,6 +48,8 @@ namespace qilang {
     void visitTypeExpr(MapTypeExprNode* node);
     void visitTypeExpr(TupleTypeExprNode* node);
     void visitTypeExpr(OptionalTypeExprNode* node);
+    void visitTypeExpr(ArrayTypeExprNode* node);
+    void visitTypeExpr(StreamTypeExprNode* node);
     void visitTypeExpr(VarArgTypeExprNode* node);
     void visitTypeExpr(KeywordArgTypeExprNode* node);
 
@@ -91,6 +95,114 @@ namespace qilang {
   template <typename T>
   void cppParamsFormat(CppTypeFormatter<T>* typeformat, ParamFieldDeclNodePtrVector node, CppParamsFormat cfpt = CppParamsFormat_Normal);
 
+  /** Size and alignment of the C++ type generated for a type expression.
+   *
+   *  Estimated for a 64-bit (LP64) target with libstdc++, which is what padding
+   *  decisions are based on: the compiler has the last word.
+   */
+  struct CppLayout {
+    std::size_t size;
+    std::size_t align;
+  };
+
+  /// A data member of a generated struct: one per field name.
+  struct CppStructMember {
+    std::string            name;
+    StructFieldDeclNodePtr field;
+    CppLayout              layout;
+    std::size_t            offset;
+  };
+  typedef std::vector<CppStructMember> CppStructMemberVector;
+
+  /// Type of the C++ variable of a constant: the declared one, else the one of its value.
+  TypeExprNodePtr cppConstType(ConstDeclNode* node);
+
+  /** Whether a constant of `type` is generated as an `inline constexpr` variable.
+   *
+   *  True for scalars, strings (as arrays of characters) and lists or arrays of those (as
+   *  `std::array`, of `const char*` for strings): they need no dynamic initialization.
+   */
+  bool isConstexprType(const TypeExprNodePtr& type);
+
+  /// Options of a `@batch(windowMs, maxCount)` method.
+  struct CppBatchOptions {
+    qi::uint64_t windowMs; // calls are gathered this long after the first one...
+    qi::uint64_t maxCount; // ...or until this many are pending
+  };
+
+  /// @return whether `node` is a `@batch` method, and then its options, defaulted to 5 ms and 64 calls.
+  bool cppBatchOptions(const FnDeclNode* node, CppBatchOptions& options);
+
+  /// Options of a `@pure` or `@cached(ttlMs, invalidatedBy)` method.
+  struct CppCacheOptions {
+    qi::uint64_t ttlMs;        // 0 for `@pure` methods: results are kept as long as the proxy
+    std::string  invalidatedBy; // signal of the interface clearing the results, if any
+  };
+
+  /// @return whether the results of `node` are cached by remote proxies, and then how.
+  bool cppCacheOptions(const FnDeclNode* node, CppCacheOptions& options);
+
+  /// @return whether the calls of `node` fail by default after `@timeout(timeoutMs)`, and then the duration.
+  bool cppTimeout(const FnDeclNode* node, qi::uint64_t& timeoutMs);
+
+  /** @return the names of the `@timeout` methods of `node`, once each. Classes redefining them
+   *  hide their deadline overloads, unless they bring them back with a using-declaration.
+   */
+  StringVector cppTimeoutMethodNames(const InterfaceDeclNode* node);
+
+  /// Whether `nodes` declare members annotated with `annotation`, which may need a runtime.
+  bool hasAnnotatedMembers(const NodePtrVector& nodes, const std::string& annotation);
+
+  /// Whether remote proxies keep a copy of the value of the property, which is the default.
+  bool cppMirrorsProperty(const PropDeclNode* node);
+
+  /// Whether `nodes` declare properties that remote proxies keep a copy of.
+  bool hasMirroredProperties(const NodePtrVector& nodes);
+
+  /// @return whether the emissions of `node` are coalesced by `@coalesce(periodMs)`, and then the period.
+  bool cppCoalescePeriod(const SigDeclNode* node, qi::uint64_t& periodMs);
+
+  /// @return whether the changes of `node` are only notified beyond `@deadband(band)`, and then the band.
+  bool cppDeadband(const PropDeclNode* node, double& band);
+
+  /** @return whether subscribers may filter the emissions of `node` by `@filterable(names...)`,
+   *  and then the names of its parameters by position, empty for the ones not filterable.
+   */
+  bool cppFilterableParameters(const SigDeclNode* node, StringVector& parameters);
+
+  /// `name` capitalized after `prefix`, as in `connectMoved` for the signal `moved`.
+  std::string cppPrefixedName(const std::string& prefix, const std::string& name);
+
+  /// Name of the class of the filters of `node`, a `@filterable` signal of the interface `iface`.
+  std::string cppSignalFilterName(const std::string& iface, const SigDeclNode* node);
+
+  /** @return the names of the statistics of the methods of `node` counted with `--instrument`, by
+   *  method in declaration order. Overloads are told apart by their rank, as in `f`, `f1`, `f2`,
+   *  followed by underscores when that is the name of another method, as in `f1_`.
+   */
+  StringVector cppMethodStatsNames(const InterfaceDeclNode* node);
+
+  /// Name of the accessor of the statistics of the methods of `iface`, as in `kindaManagerStats`.
+  std::string cppMethodStatsAccessor(const std::string& iface);
+
+  /** @return the opening lines of the wrappers of the calls of `node`, the method of index
+   *  `method` of the interface `iface`, by the runtimes of `--probes`, `--trace` and
+   *  `--instrument`: outermost first, each returning what it wraps and closed by `});`.
+   */
+  StringVector cppCallWrappers(const CodegenOptions& options, const std::string& iface, const FnDeclNode* node,
+                               unsigned int method);
+
+  /// @param reorder whether structs are generated with their members reordered (see cppStructLayout)
+  CppLayout cppTypeLayout(const PackageManagerPtr& pm, const TypeExprNodePtr& type, bool reorder);
+
+  /** Members of the generated struct, in storage order, with their offsets.
+   *
+   *  If `reorder` is true, members are sorted by decreasing alignment (keeping the declaration
+   *  order between members of the same alignment), which minimizes the padding.
+   */
+  CppStructMemberVector cppStructLayout(const PackageManagerPtr& pm, const StructDeclNode* node, bool reorder,
+                                        CppLayout& layout);
+
 }
 
 #include <cpptype.hxx>
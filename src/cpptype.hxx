@@ -85,6 +85,20 @@ void CppTypeFormatter<T>::visitTypeExpr(OptionalTypeExprNode* node) {
   this->out() << " >" << constattr("&");
 }
 
+template <typename T>
+void CppTypeFormatter<T>::visitTypeExpr(ArrayTypeExprNode* node) {
+  this->out() << constattr("const ") << "std::array< ";
+  unconstify(node->element);
+  this->out() << ", " << node->size << " >" << constattr("&");
+}
+
+template <typename T>
+void CppTypeFormatter<T>::visitTypeExpr(StreamTypeExprNode* node) {
+  this->out() << constattr("const ") << "qilang::Stream< ";
+  unconstify(node->element);
+  this->out() << " >" << constattr("&");
+}
+
 template <typename T>
 void CppTypeFormatter<T>::visitTypeExpr(VarArgTypeExprNode* node) {
   this->out() << constattr("const ") << "qi::VarArguments< ";
@@ -109,32 +123,73 @@ void CppTypeFormatter<T>::visitData(BoolLiteralNode *node) {
 
 template <typename T>
 void CppTypeFormatter<T>::visitData(IntLiteralNode *node) {
-  this->out() << node->value;
+  const qi::uint64_t int64Max = static_cast<qi::uint64_t>(std::numeric_limits<qi::int64_t>::max());
+  // neither the min of qi::int64_t nor values above the max of qi::int64_t are valid C++ literals as is
+  if (node->negative() && node->value == int64Max + 1)
+    this->out() << "(-" << int64Max << " - 1)";
+  else if (node->negative())
+    this->out() << static_cast<qi::int64_t>(node->value);
+  else if (node->value > int64Max)
+    this->out() << node->value << "ULL";
+  else
+    this->out() << node->value;
 }
 
 template <typename T>
 void CppTypeFormatter<T>::visitData(FloatLiteralNode *node) {
+  const std::streamsize precision = this->out().precision(std::numeric_limits<double>::max_digits10);
   this->out() << node->value;
+  this->out().precision(precision);
 }
 
 template <typename T>
 void CppTypeFormatter<T>::visitData(StringLiteralNode *node) {
-  this->out() << node->value;
+  // escape sequences are written as in C++, only line breaks need escaping
+  this->out() << "\"";
+  for (char c : node->value) {
+    if (c == '\n')
+      this->out() << "\\n";
+    else
+      this->out() << c;
+  }
+  this->out() << "\"";
 }
 
 template <typename T>
 void CppTypeFormatter<T>::visitData(TupleLiteralNode* node) {
-  this->out() << "(" << "FAIL" << ")";
+  this->out() << "{ ";
+  for (unsigned i = 0; i < node->values.size(); ++i) {
+    if (i)
+      this->out() << ", ";
+    this->accept(node->values.at(i));
+  }
+  this->out() << " }";
 }
 
 template <typename T>
 void CppTypeFormatter<T>::visitData(ListLiteralNode* node) {
-  this->out() << "[" << "FAIL" << "]";
+  this->out() << "{ ";
+  for (unsigned i = 0; i < node->values.size(); ++i) {
+    if (i)
+      this->out() << ", ";
+    this->accept(node->values.at(i));
+  }
+  this->out() << " }";
 }
 
 template <typename T>
 void CppTypeFormatter<T>::visitData(DictLiteralNode* node) {
-  this->out() << "{" << "FAIL" << "}";
+  this->out() << "{ ";
+  for (unsigned i = 0; i < node->values.size(); ++i) {
+    if (i)
+      this->out() << ", ";
+    this->out() << "{ ";
+    this->accept(node->values.at(i).first);
+    this->out() << ", ";
+    this->accept(node->values.at(i).second);
+    this->out() << " }";
+  }
+  this->out() << " }";
 }
 
 template <typename T>
@@ -174,15 +229,25 @@ std::string toName(const std::string& name, int counter);
 
 template <typename T>
 void cppFormatParam(CppTypeFormatter<T>* fmt, ParamFieldDeclNodePtr node, CppParamsFormat cfpt, int counter) {
+  // @sink parameters are taken by value and moved along the whole call chain
+  const bool sink = node->hasAnnotation("sink");
   for (unsigned i = 0; i < node->names.size(); ++i) {
     switch(node->paramType) {
       case ParamFieldType_Normal: {
         if (cfpt != CppParamsFormat_NameOnly) {
-          fmt->constify(node->effectiveType());
+          if (sink)
+            fmt->unconstify(node->effectiveType());
+          else
+            fmt->constify(node->effectiveType());
           fmt->out() << " ";
         }
-        if (cfpt != CppParamsFormat_TypeOnly)
-          fmt->out() << toName(node->names.at(i), counter);
+        if (cfpt != CppParamsFormat_TypeOnly) {
+          // moved where it is passed on, not where it is declared
+          if (sink && cfpt == CppParamsFormat_NameOnly)
+            fmt->out() << "std::move(" << toName(node->names.at(i), counter) << ")";
+          else
+            fmt->out() << toName(node->names.at(i), counter);
+        }
         break;
       }
       case ParamFieldType_VarArgs: {
@@ -5,13 +5,16 @@
 ** Copyright (C) 2014 Aldebaran Robotics
 */
 
-#include <iostream>
+#include <map>
+#include <mutex>
 
 #include <qilang/formatter.hpp>
 #include <qilang/node.hpp>
 #include <qilang/visitor.hpp>
 
 #include <qi/anyvalue.hpp>
+#include <boost/smart_ptr/owner_less.hpp>
+#include <boost/weak_ptr.hpp>
 
 namespace qilang {
   /**
@@ -34,7 +37,10 @@ namespace qilang {
       av = qi::AnyValue::from(node->value);
     }
     void visitData(IntLiteralNode *node) {
-      av = qi::AnyValue::from(node->value);
+      if (node->negative())
+        av = qi::AnyValue::from(static_cast<qi::int64_t>(node->value));
+      else
+        av = qi::AnyValue::from(node->value);
     }
     void visitData(FloatLiteralNode *node) {
       av = qi::AnyValue::from(node->value);
@@ -42,8 +48,14 @@ namespace qilang {
     void visitData(StringLiteralNode *node) {
       av = qi::AnyValue::from(node->value);
     }
-    void visitData(TupleLiteralNode*) {
-      throw std::runtime_error("not implemented");
+    void visitData(TupleLiteralNode* node) {
+      std::vector<qi::AnyValue> values;
+      for (unsigned i = 0; i < node->values.size(); ++i)
+        values.push_back(convert(node->values.at(i)));
+      qi::AnyReferenceVector refs;
+      for (unsigned i = 0; i < values.size(); ++i)
+        refs.push_back(values.at(i).asReference());
+      av = qi::AnyValue::makeTuple(refs);
     }
 
     void visitData(ListLiteralNode* node) {
@@ -59,15 +71,53 @@ namespace qilang {
     }
 
     void visitData(DictLiteralNode* node) {
-      std::cout << "DictConstNode visitor" << std::endl;
-      throw std::runtime_error("not implemented");
+      std::map<qi::AnyValue, qi::AnyValue> values;
+      for (unsigned i = 0; i < node->values.size(); ++i) {
+        qi::AnyValue key = convert(node->values.at(i).first);
+        values[key] = convert(node->values.at(i).second);
+      }
+      av = qi::AnyValue::from(values);
     }
 
   };
 
+  namespace {
+    // Values of the literals already converted. Literals are immutable once parsed.
+    class AnyValueCache {
+    public:
+      qi::AnyValue get(const NodePtr& node) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Values::const_iterator it = _values.find(node);
+        if (it != _values.end())
+          return it->second;
+
+        qi::AnyValue value = DataToAnyValueVisitor().convert(boost::static_pointer_cast<LiteralNode>(node));
+        // forget the literals of the ASTs which were destroyed
+        if (_values.size() >= 2 * _sizeAfterPurge) {
+          for (Values::iterator value = _values.begin(); value != _values.end();) {
+            if (value->first.expired())
+              value = _values.erase(value);
+            else
+              ++value;
+          }
+          _sizeAfterPurge = std::max<std::size_t>(_values.size(), 64);
+        }
+        _values[node] = value;
+        return value;
+      }
+
+    private:
+      typedef std::map<boost::weak_ptr<Node>, qi::AnyValue, boost::owner_less<boost::weak_ptr<Node> > > Values;
+      std::mutex  _mutex;
+      Values      _values;
+      std::size_t _sizeAfterPurge = 64;
+    };
+  }
+
   qi::AnyValue toAnyValue(const NodePtr& node) {
+    static AnyValueCache cache;
     if (node->kind() == NodeKind_Literal)
-      return DataToAnyValueVisitor().convert(boost::static_pointer_cast<LiteralNode>(node));
+      return cache.get(node);
     throw std::runtime_error("bad node kind");
   }
 
@@ -180,6 +180,8 @@ public:
           generateTypeRegistrationCall(mockClassName);
           generateTypeRegistrationCall(niceMockClassName);
           generateTypeRegistrationCall(strictMockClassName);
+          // The mock may as well end up behind the interface, whose registration may be deferred.
+          indent() << "::qilang::detail::TypeRegistry::ensureRegistered(typeid(" << node->name << "));\n";
           indent() << "return true;\n";
         } // registration
         indent() << "}();\n";
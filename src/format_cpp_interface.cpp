@@ -6,6 +6,8 @@
 */
 
 #include <iostream>
+#include <map>
+#include <set>
 #include <qi/log.hpp>
 #include <qilang/node.hpp>
 #include <qilang/formatter.hpp>
@@ -25,9 +27,10 @@ namespace qilang {
 class QiLangGenAsyncIface: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
 {
 public:
-  QiLangGenAsyncIface(std::stringstream& ss, std::string api)
+  QiLangGenAsyncIface(std::stringstream& ss, std::string api, bool instrument)
     : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss)
     , apiExport(api)
+    , _instrument(instrument)
   {}
 
   void visitDecl(InterfaceDeclNode* node) {
@@ -47,6 +50,14 @@ public:
     indent() << "public:" << std::endl;
     //add a virtual destructor
     indent() << "  virtual ~" << node->name << "Async() {}" << std::endl;
+    if (_instrument) {
+      // Only local bindings and remote proxies count the calls of the methods.
+      const std::string accessor = cppMethodStatsAccessor(node->name);
+      indent() << "  virtual " << node->name << "MethodStats " << accessor << "() const {" << std::endl;
+      indent() << "    return " << node->name << "MethodStats();" << std::endl;
+      indent() << "  }" << std::endl;
+      indent() << "  virtual void " << cppPrefixedName("reset", accessor) << "() {}" << std::endl;
+    }
     scoped(node->values);
     indent() << "};" << std::endl << std::endl;
   }
@@ -62,6 +73,20 @@ public:
     out() << " > " << node->name << "(";
     cppParamsFormat(this, node->args);
     out() << ")" << virtualAttr(" = 0") << ";" << std::endl;
+
+    qi::uint64_t timeoutMs = 0;
+    if (!cppTimeout(node, timeoutMs))
+      return;
+    // Remote proxies replace the default deadline of the calls by this one.
+    indent() << "virtual ::qi::Future< ";
+    NodeFormatter::accept(node->effectiveRet());
+    out() << " > " << node->name << "(";
+    cppParamsFormat(this, node->args);
+    out() << (node->args.empty() ? "" : ", ") << "::qi::SteadyClockTimePoint deadline) {" << std::endl;
+    indent() << "  return ::qilang::detail::withDeadline(deadline, [&] { return " << node->name << "(";
+    cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+    out() << "); });" << std::endl;
+    indent() << "}" << std::endl;
   }
 
   void visitDecl(SigDeclNode* node) {
@@ -72,6 +97,9 @@ public:
   FormatAttr  virtualAttr;
   FormatAttr  apiAttr;
   std::string apiExport;
+
+private:
+  bool _instrument;
 };
 
 class QiLangGenIfaceSigPropParam: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
@@ -143,17 +171,107 @@ public:
   }
 };
 
+// The filters of the `@filterable` signals of an interface, which subscribers build with a
+// method per bound of each parameter that can be filtered on.
+class QiLangGenSignalFilters: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
+{
+public:
+  QiLangGenSignalFilters(std::stringstream& ss)
+    : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss)
+  {}
+
+  void visitDecl(InterfaceDeclNode* node) {
+    _ifaceName = node->name;
+    for (unsigned int i = 0; i < node->values.size(); ++i)
+      accept(node->values.at(i));
+  }
+
+  void visitDecl(FnDeclNode* node) {}
+  void visitDecl(PropDeclNode* node) {}
+
+  void visitDecl(SigDeclNode* node) {
+    StringVector parameters;
+    if (!cppFilterableParameters(node, parameters))
+      return;
+    const std::string filterName = cppSignalFilterName(_ifaceName, node);
+    indent() << "// Filter of the emissions of `" << _ifaceName << "::" << node->name
+             << "`, evaluated where the signal is emitted." << std::endl;
+    indent() << "class " << filterName << " {" << std::endl;
+    indent() << "public:" << std::endl;
+    {
+      ScopedIndent _i(_indent);
+      indent() << filterName << "() {}" << std::endl;
+      indent() << "explicit " << filterName << "(::qilang::detail::SignalFilter clauses)" << std::endl;
+      indent() << "  : _clauses(std::move(clauses))" << std::endl;
+      indent() << "{}" << std::endl;
+      unsigned int position = 0;
+      for (unsigned int i = 0; i < node->args.size(); ++i) {
+        for (unsigned int j = 0; j < node->args.at(i)->names.size(); ++j, ++position) {
+          if (!parameters.at(position).empty())
+            formatBounds(filterName, parameters.at(position), node->args.at(i)->effectiveType());
+        }
+      }
+      indent() << "const ::qilang::detail::SignalFilter& clauses() const {" << std::endl;
+      indent() << "  return _clauses;" << std::endl;
+      indent() << "}" << std::endl;
+      // empty for the parameters that cannot be filtered on
+      indent() << "static std::vector<std::string> parameters() {" << std::endl;
+      indent() << "  return { ";
+      for (unsigned int i = 0; i < parameters.size(); ++i) {
+        if (i > 0)
+          out() << ", ";
+        out() << "\"" << parameters.at(i) << "\"";
+      }
+      out() << " };" << std::endl;
+      indent() << "}" << std::endl;
+    }
+    indent() << "private:" << std::endl;
+    indent() << "  ::qilang::detail::SignalFilter _clauses;" << std::endl;
+    indent() << "};" << std::endl << std::endl;
+  }
+
+private:
+  void formatBounds(const std::string& filterName, const std::string& parameter, const TypeExprNodePtr& type) {
+    formatBound(filterName, parameter, type, "Is", "value, value", "value");
+    formatBound(filterName, parameter, type, "Between", "min, max", "min", "max");
+    formatBound(filterName, parameter, type, "AtLeast", "min", "min");
+    formatBound(filterName, parameter, type, "AtMost", "max", "max");
+  }
+
+  void formatBound(const std::string& filterName, const std::string& parameter, const TypeExprNodePtr& type,
+                   const std::string& bound, const std::string& args, const std::string& first,
+                   const std::string& second = std::string()) {
+    indent() << filterName << "& " << parameter << bound << "(";
+    constify(type);
+    out() << " " << first;
+    if (!second.empty()) {
+      out() << ", ";
+      constify(type);
+      out() << " " << second;
+    }
+    out() << ") {" << std::endl;
+    const std::string helper = bound == "AtLeast" ? "filterAtLeast" : bound == "AtMost" ? "filterAtMost" : "filterBetween";
+    indent() << "  ::qilang::detail::" << helper << "(_clauses, \"" << parameter << "\", " << args << ");" << std::endl;
+    indent() << "  return *this;" << std::endl;
+    indent() << "}" << std::endl;
+  }
+
+  std::string _ifaceName;
+};
+
 class QiLangGenIface: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
 {
 public:
-  QiLangGenIface(std::stringstream& ss, std::string api)
+  QiLangGenIface(std::stringstream& ss, std::string api, bool instrument)
     : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss)
     , apiExport(api)
+    , _instrument(instrument)
   {}
 
   void visitDecl(InterfaceDeclNode* node) {
     ScopedFormatAttrActivate _(virtualAttr);
     ScopedFormatAttrBlock    _2(apiAttr);
+    _ifaceName = node->name;
 
     indent() << "class " << node->name;
     if (node->inherits.size() > 0) {
@@ -180,9 +298,20 @@ public:
         QiLangGenIfaceSigPropParamInit sigpropinit(out(), _indent);
         sigpropinit.scoped(node->values);
       }
-      indent() << "{}" << std::endl;
+      indent() << "{" << std::endl;
+      // Registers the type if it was deferred, whatever the implementation, see `qilang::detail::TypeRegistry`.
+      indent() << "  ::qilang::detail::TypeRegistry::ensureRegistered(typeid(" << node->name << "));" << std::endl;
+      indent() << "}" << std::endl;
       indent() << "virtual ~" << node->name << "() {}" << std::endl;
       indent() << "virtual " << node->name << "Async& async() = 0;" << std::endl;
+      if (_instrument) {
+        // Only local bindings and remote proxies count the calls of the methods.
+        const std::string accessor = cppMethodStatsAccessor(node->name);
+        indent() << "virtual " << node->name << "MethodStats " << accessor << "() const {" << std::endl;
+        indent() << "  return " << node->name << "MethodStats();" << std::endl;
+        indent() << "}" << std::endl;
+        indent() << "virtual void " << cppPrefixedName("reset", accessor) << "() {}" << std::endl;
+      }
     }
     scoped(node->values);
 
@@ -199,6 +328,19 @@ public:
     out() << " " << node->name << "(";
     cppParamsFormat(this, node->args);
     out() << ")" << virtualAttr(" = 0") << ";" << std::endl;
+
+    qi::uint64_t timeoutMs = 0;
+    if (!cppTimeout(node, timeoutMs))
+      return;
+    indent();
+    NodeFormatter::accept(node->effectiveRet());
+    out() << " " << node->name << "(";
+    cppParamsFormat(this, node->args);
+    out() << (node->args.empty() ? "" : ", ") << "::qi::SteadyClockTimePoint deadline) {" << std::endl;
+    indent() << "  " << (node->hasNoReturn() ? "" : "return ") << "async()." << node->name << "(";
+    cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+    out() << (node->args.empty() ? "" : ", ") << "deadline).value();" << std::endl;
+    indent() << "}" << std::endl;
   }
 
   void visitDecl(SigDeclNode* node) {
@@ -214,6 +356,18 @@ public:
       indent() << "return " << node->name << ";" << std::endl;
     }
     indent() << "}" << std::endl;
+    StringVector parameters;
+    if (cppFilterableParameters(node, parameters)) {
+      // Only the emissions passing the filter reach the subscriber, remote ones included.
+      indent() << apiAttr(apiExport + " ") << virtualAttr("virtual ") << "::qi::Future< ::qi::SignalLink > "
+               << cppPrefixedName("connect", node->name) << "(const " << cppSignalFilterName(_ifaceName, node)
+               << "& filter, ::boost::function< void(";
+      cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+      out() << ") > subscriber)" << virtualAttr(" = 0") << ";" << std::endl;
+      indent() << apiAttr(apiExport + " ") << virtualAttr("virtual ") << "::qi::Future< void > "
+               << cppPrefixedName("disconnect", node->name) << "(::qi::SignalLink link)" << virtualAttr(" = 0")
+               << ";" << std::endl;
+    }
   }
   void visitDecl(PropDeclNode* node) {
     ScopedFormatAttrBlock _(constattr);
@@ -233,6 +387,8 @@ public:
   FormatAttr  virtualAttr;
   FormatAttr  apiAttr;
   std::string apiExport;
+  std::string _ifaceName;
+  bool _instrument;
 };
 
 /// Used for the first pass, to forward-declare interfaces.
@@ -262,12 +418,14 @@ public:
 class QiLangGenObjectDef: public CppTypeFormatter<>
 {
 public:
-  QiLangGenObjectDef(const PackageManagerPtr& pm, const ParseResultPtr& pr, const StringVector& includes)
+  QiLangGenObjectDef(const PackageManagerPtr& pm, const ParseResultPtr& pr, const StringVector& includes,
+                     const CodegenOptions& options)
     : toclose(0)
     , currentNs()
     , _pm(pm)
     , _pr(pr)
     , _includes(includes)
+    , _options(options)
   {
     _includes.push_back(qiLangToCppInclude(pm->package(pr->package), "api"));
 
@@ -309,9 +467,13 @@ public:
   virtual void doAccept(Node* node) override { node->accept(this); }
 
   void visitDecl(InterfaceDeclNode* node) override {
-    QiLangGenAsyncIface ai(out(), apiExport);
+    if (_options.instrument)
+      formatMethodStats(node);
+    QiLangGenSignalFilters filters(out());
+    node->accept(&filters);
+    QiLangGenAsyncIface ai(out(), apiExport, _options.instrument);
     node->accept(&ai);
-    QiLangGenIface si(out(), apiExport);
+    QiLangGenIface si(out(), apiExport, _options.instrument);
     node->accept(&si);
 
     {
@@ -334,18 +496,38 @@ public:
       out() << " {" << std::endl;
       out() << "    static bool dummyCall();" << std::endl;
       out() << "  };" << std::endl;
-      // call the dummyCall (to force the link of this lib when we will do the #include)
-      out() << "  static bool ";
+      std::string anchorPrefix;
       for (unsigned int i = 0; i < currentNs.size(); ++i) {
-        out() << currentNs.at(i);
+        anchorPrefix += currentNs.at(i);
       }
-      out() << node->name << "QiLangDummyVar =" << forceProxyInclusionTypeStr;
-      out() << "::dummyCall();" << std::endl;
+      anchorPrefix += node->name;
+      // reference the dummyCall (to force the link of this lib when we will do the #include).
+      // It is a constant: unlike a call, it costs nothing when the header is included.
+      out() << "#if defined(__GNUC__)" << std::endl;
+      out() << "  __attribute__((used)) static bool (* const " << anchorPrefix << "QiLangProxyAnchor)() = &"
+            << forceProxyInclusionTypeStr << "::dummyCall;" << std::endl;
+      out() << "#else" << std::endl;
+      // the address of a dllimport function is not a constant for MSVC, which may drop an unused
+      // reference: call the dummyCall there
+      out() << "  static bool " << anchorPrefix << "QiLangDummyVar =" << forceProxyInclusionTypeStr
+            << "::dummyCall();" << std::endl;
+      out() << "#endif" << std::endl;
       out() << "}" << std::endl;
       out() << "}" << std::endl;
     }
   }
 
+  // The statistics of the calls of the methods of an interface, counted with `--instrument`.
+  void formatMethodStats(InterfaceDeclNode* node) {
+    const StringVector names = cppMethodStatsNames(node);
+    indent() << "// Statistics of the calls of the methods of `" << node->name
+             << "`, by method: overloads are told apart by their rank." << std::endl;
+    indent() << "struct " << node->name << "MethodStats {" << std::endl;
+    for (unsigned int i = 0; i < names.size(); ++i)
+      indent() << "  ::qilang::detail::MethodStatsSnapshot " << names.at(i) << ";" << std::endl;
+    indent() << "};" << std::endl << std::endl;
+  }
+
   void visitDecl(ParamFieldDeclNode* node) override {
   }
 
@@ -360,7 +542,10 @@ public:
   void visitDecl(StructDeclNode* node) override {
     indent() << "struct " << node->name << " {" << std::endl;
     ScopedFormatAttrBlock _(constattr);
-    scoped(node->decls);
+    if (_options.reorderStructFields)
+      reorderedFields(node);
+    else
+      scoped(node->decls);
 
     StringVector fields, optionalFields;
     for (unsigned int i = 0; i < node->decls.size(); ++i) {
@@ -394,14 +579,152 @@ public:
       if (!optionalFields.empty()) {
         printStructMacro("QI_TYPE_STRUCT_EXTENSION_ADDED_FIELDS", optionalFields, true);
       }
-      printStructMacro("QI_TYPE_STRUCT", fields, false);
+      // Versioned structs keep the reflection of the macro, which the extension relies on.
+      // Structs without fields have nothing to index: the macro is as fast for them.
+      if (_options.specializedStructs && optionalFields.empty() && !fields.empty())
+        printStructTypeImpl(node->name, fields);
+      else
+        printStructMacro("QI_TYPE_STRUCT", fields, false);
       out() << std::endl;
     }
+
+    if (const Annotation* columnsOf = node->annotation("columnsof"))
+      printColumnsConversions(node->name, static_cast<StringLiteralNode*>(columnsOf->args.at(0).get())->value, fields);
   }
 
+  // Conversions between a `@columns` struct stored in a vector (rows) and its companion (columns).
+  void printColumnsConversions(const std::string& columnsName, const std::string& rowName, const StringVector& fields) {
+    if (fields.empty())
+      return;
+    indent() << "inline " << columnsName << " toColumns(const std::vector< " << rowName << " >& rows) {" << std::endl;
+    {
+      ScopedIndent _(_indent);
+      indent() << columnsName << " columns;" << std::endl;
+      for (auto&& field : fields)
+        indent() << "columns." << field << ".reserve(rows.size());" << std::endl;
+      indent() << "for (const auto& row : rows) {" << std::endl;
+      for (auto&& field : fields)
+        indent() << "  columns." << field << ".push_back(row." << field << ");" << std::endl;
+      indent() << "}" << std::endl;
+      indent() << "return columns;" << std::endl;
+    }
+    indent() << "}" << std::endl << std::endl;
+
+    indent() << "inline std::vector< " << rowName << " > toRows(const " << columnsName << "& columns) {" << std::endl;
+    {
+      ScopedIndent _(_indent);
+      indent() << "const auto size = columns." << fields.front() << ".size();" << std::endl;
+      for (unsigned int i = 1; i < fields.size(); ++i) {
+        indent() << "if (columns." << fields.at(i) << ".size() != size)" << std::endl;
+        indent() << "  throw std::length_error(\"" << columnsName << ": column '" << fields.at(i)
+                 << "' does not have the size of column '" << fields.front() << "'\");" << std::endl;
+      }
+      indent() << "std::vector< " << rowName << " > rows(size);" << std::endl;
+      indent() << "for (std::size_t i = 0; i < size; ++i) {" << std::endl;
+      for (auto&& field : fields)
+        indent() << "  rows[i]." << field << " = columns." << field << "[i];" << std::endl;
+      indent() << "}" << std::endl;
+      indent() << "return rows;" << std::endl;
+    }
+    indent() << "}" << std::endl << std::endl;
+  }
+
+  // Members are stored by decreasing alignment, the registration keeps the declaration order.
+  void reorderedFields(StructDeclNode* node) {
+    ScopedIndent _(_indent);
+    for (unsigned int i = 0; i < node->decls.size(); ++i) {
+      if (node->decls.at(i)->type() != NodeType_StructFieldDecl)
+        accept(node->decls.at(i));
+    }
+    CppLayout layout;
+    const CppStructMemberVector members = cppStructLayout(_pm, node, true, layout);
+    for (unsigned int i = 0; i < members.size(); ++i) {
+      const CppStructMember& member = members.at(i);
+      indent();
+      accept(member.field->effectiveType());
+      out() << " " << member.name;
+      if (member.field->data) {
+        out() << " = ";
+        accept(member.field->data);
+      }
+      out() << ";" << std::endl;
+    }
+  }
+
+  // Same registration as QI_TYPE_STRUCT, with direct access to the fields.
+  void printStructTypeImpl(const std::string& name, const StringVector& fields) {
+    std::string fullName;
+    for (auto&& value : currentNs) {
+      fullName += "::" + value;
+    }
+    fullName += "::" + name;
+
+    out() << "namespace qi {" << std::endl;
+    out() << "  template <>" << std::endl;
+    out() << "  class TypeImpl< " << fullName << " >" << std::endl;
+    out() << "    : public ::qilang::detail::StructTypeImpl< " << fullName;
+    for (auto&& field : fields) {
+      out() << ", &" << fullName << "::" << field;
+    }
+    out() << " >" << std::endl;
+    out() << "  {" << std::endl;
+    out() << "  public:" << std::endl;
+    out() << "    TypeImpl()" << std::endl;
+    out() << "      : StructTypeImpl(\"" << fullName << "\", {";
+    for (unsigned int i = 0; i < fields.size(); ++i) {
+      out() << " \"" << fields.at(i) << "\"";
+      if (i + 1 < fields.size())
+        out() << ",";
+    }
+    out() << " })" << std::endl;
+    out() << "    {}" << std::endl;
+    out() << "  };" << std::endl;
+    out() << "}" << std::endl;
+  }
+
+  static bool isStringType(const TypeExprNodePtr& type) {
+    return type->type() == NodeType_BuiltinTypeExpr
+        && static_cast<BuiltinTypeExprNode*>(type.get())->builtinType == BuiltinType_String;
+  }
+
+  // type of an element of a constexpr constant: strings are plain literals
+  void printConstexprElementType(const TypeExprNodePtr& type) {
+    if (isStringType(type))
+      out() << "const char*";
+    else
+      accept(type);
+  }
+
+  // Constants are defined in headers included in many translation units: `inline` gives
+  // them a single definition, and whenever possible they are constant-initialized.
   void visitDecl(ConstDeclNode* node) override {
-    indent() << "const ";
-    accept(node->effectiveType());
+    TypeExprNodePtr type = cppConstType(node);
+    if (!isConstexprType(type)) {
+      indent() << "inline const ";
+      accept(type);
+    } else if (type->type() == NodeType_ListTypeExpr || type->type() == NodeType_ArrayTypeExpr) {
+      std::size_t size;
+      TypeExprNodePtr element;
+      if (type->type() == NodeType_ListTypeExpr) {
+        element = static_cast<ListTypeExprNode*>(type.get())->element;
+        size = static_cast<ListLiteralNode*>(node->data.get())->values.size();
+      } else {
+        element = static_cast<ArrayTypeExprNode*>(type.get())->element;
+        size = static_cast<ArrayTypeExprNode*>(type.get())->size;
+      }
+      indent() << "inline constexpr std::array< ";
+      printConstexprElementType(element);
+      out() << ", " << size << " >";
+    } else if (isStringType(type)) {
+      // an array of characters, that converts to the string types of consumers
+      indent() << "inline constexpr char " << node->name << "[] = ";
+      accept(node->data);
+      out() << ";" << std::endl;
+      return;
+    } else {
+      indent() << "inline constexpr ";
+      printConstexprElementType(type);
+    }
     out() << " " << node->name;
     if (node->data) {
       out() << " = ";
@@ -424,18 +747,120 @@ public:
   }
 
   void visitDecl(EnumDeclNode* node) override {
-    indent() << "enum class " << node->name << " {" << std::endl;
+    indent() << "enum class " << node->name;
+    if (node->underlyingType) {
+      out() << " : ";
+      accept(node->underlyingType);
+    }
+    out() << " {" << std::endl;
     scoped(node->fields);
     indent() << "};" << std::endl << std::endl;
+    if (node->flags)
+      printFlagsOperators(node);
+    printEnumReflection(node);
     {
       ScopedNamespaceEscaper _e(out(), currentNs);
-      out() << "QI_TYPE_ENUM(";
+      std::string fullName;
       for (unsigned int i = 0; i < currentNs.size(); ++i) {
-        out() << "::" << currentNs.at(i);
+        fullName += "::" + currentNs.at(i);
+      }
+      fullName += "::" + node->name;
+      if (node->underlyingType) {
+        // QI_TYPE_ENUM registers an int: the storage of the enum would not match.
+        out() << "namespace qi {" << std::endl;
+        out() << "  template<> class TypeImpl< " << fullName << " >" << std::endl;
+        out() << "    : public IntTypeInterfaceImpl< std::underlying_type< " << fullName << " >::type > {};" << std::endl;
+        out() << "}" << std::endl << std::endl;
       }
-      out() << "::" << node->name << ")" << std::endl << std::endl;
+      else
+        out() << "QI_TYPE_ENUM(" << fullName << ")" << std::endl << std::endl;
     }
   }
+  // Conversions between the values of an enum and their names, which need neither the
+  // type system nor allocations: `toString` is a switch, `fromString` a binary search
+  // in the table of the names, sorted at generation time.
+  void printEnumReflection(EnumDeclNode* node) {
+    const std::string& name = node->name;
+    std::map<std::string, std::string> names;
+    std::vector<std::string> cases;
+    std::set<qi::uint64_t> values;
+    for (unsigned int i = 0; i < node->fields.size(); ++i) {
+      if (node->fields.at(i)->fieldType != EnumFieldType_Const)
+        continue;
+      ConstDeclNode* field = static_cast<ConstDeclNode*>(node->fields.at(i)->node.get());
+      names[field->name] = name + "::" + field->name;
+      // aliases of a value would be duplicate cases
+      IntLiteralNode* value = dynamic_cast<IntLiteralNode*>(field->data.get());
+      if (value && values.insert(value->value).second)
+        cases.push_back(field->name);
+    }
+    const std::string table = "detail::" + name + "Names";
+
+    indent() << "namespace detail {" << std::endl;
+    indent() << "  inline constexpr std::pair< std::string_view, " << name << " > " << name << "Names[] = {" << std::endl;
+    for (const auto& entry : names)
+      indent() << "    { \"" << entry.first << "\", " << entry.second << " }," << std::endl;
+    if (names.empty())
+      indent() << "    { \"\", " << name << "() }," << std::endl;
+    indent() << "  };" << std::endl;
+    indent() << "}" << std::endl << std::endl;
+
+    indent() << "/// @return the name of `value`, or an empty string if it has none" << std::endl;
+    indent() << "constexpr std::string_view toString(" << name << " value) {" << std::endl;
+    indent() << "  switch (value) {" << std::endl;
+    for (const auto& field : cases)
+      indent() << "    case " << name << "::" << field << ": return \"" << field << "\";" << std::endl;
+    indent() << "  }" << std::endl;
+    indent() << "  return std::string_view();" << std::endl;
+    indent() << "}" << std::endl << std::endl;
+
+    indent() << "/// @return false if `name` is not the name of a value of " << name << std::endl;
+    indent() << "constexpr bool fromString(std::string_view name, " << name << "& value) {" << std::endl;
+    {
+      ScopedIndent _(_indent);
+      indent() << "std::size_t first = 0;" << std::endl;
+      indent() << "std::size_t last = " << names.size() << ";" << std::endl;
+      indent() << "while (first < last) {" << std::endl;
+      indent() << "  const std::size_t middle = first + (last - first) / 2;" << std::endl;
+      indent() << "  if (" << table << "[middle].first < name)" << std::endl;
+      indent() << "    first = middle + 1;" << std::endl;
+      indent() << "  else" << std::endl;
+      indent() << "    last = middle;" << std::endl;
+      indent() << "}" << std::endl;
+      indent() << "if (first == " << names.size() << " || " << table << "[first].first != name)" << std::endl;
+      indent() << "  return false;" << std::endl;
+      indent() << "value = " << table << "[first].second;" << std::endl;
+      indent() << "return true;" << std::endl;
+    }
+    indent() << "}" << std::endl << std::endl;
+  }
+
+  // Bitwise operators of `flags`, which are found by ADL. `~` only keeps the declared flags.
+  void printFlagsOperators(EnumDeclNode* node) {
+    const std::string& name = node->name;
+    const std::string cast = "static_cast< "
+      + detail::builtinTypeToCpp(static_cast<BuiltinTypeExprNode*>(node->underlyingType.get())->builtinType, false) + " >";
+    qi::uint64_t mask = 0;
+    for (unsigned int i = 0; i < node->fields.size(); ++i) {
+      ConstDeclNode* field = static_cast<ConstDeclNode*>(node->fields.at(i)->node.get());
+      mask |= static_cast<IntLiteralNode*>(field->data.get())->value;
+    }
+
+    const char* ops[] = { "|", "&", "^" };
+    for (const char* op : ops) {
+      indent() << "constexpr " << name << " operator" << op << "(" << name << " lhs, " << name << " rhs) {" << std::endl;
+      indent() << "  return static_cast< " << name << " >(" << cast << "(lhs) " << op << " " << cast << "(rhs));" << std::endl;
+      indent() << "}" << std::endl << std::endl;
+    }
+    indent() << "constexpr " << name << " operator~(" << name << " flags) {" << std::endl;
+    indent() << "  return static_cast< " << name << " >(~" << cast << "(flags) & " << mask << "u);" << std::endl;
+    indent() << "}" << std::endl << std::endl;
+    indent() << "/// @return whether all of `flags` are set in `set`" << std::endl;
+    indent() << "constexpr bool has(" << name << " set, " << name << " flags) {" << std::endl;
+    indent() << "  return (set & flags) == flags;" << std::endl;
+    indent() << "}" << std::endl << std::endl;
+  }
+
   void visitDecl(EnumFieldDeclNode* node) override {
     if (node->fieldType == EnumFieldType_Const) {
       ConstDeclNode* tnode = static_cast<ConstDeclNode*>(node->node.get());
@@ -456,6 +881,7 @@ public:
   PackageManagerPtr  _pm;
   const ParseResultPtr& _pr;
   StringVector       _includes;
+  const CodegenOptions _options;
 
   void formatHeader() override {
     indent() << "/*" << std::endl;
@@ -470,6 +896,120 @@ public:
       indent() << "#include " << _includes.at(i) << std::endl;
     }
     indent() << std::endl;
+
+    // The constructors of interfaces run their deferred type registration.
+    if (!findNode(_pr->ast, NodeType_InterfaceDecl).empty()) {
+      const char* commonCode =
+      #include <qilang/detail/gencodeutility.txt>
+      ;
+      out() << commonCode;
+      indent() << std::endl;
+    }
+    // As for the common code of local headers, `qilang::SharedBuffer` is injected
+    // because targets using qicc do not necessarily depend on libqilang.
+    if (usesBuiltinType(BuiltinType_RawView)) {
+      const char* sharedBufferCode =
+      #include <qilang/detail/sharedbuffer.txt>
+      ;
+      out() << sharedBufferCode;
+      indent() << std::endl;
+    }
+    if (_options.specializedStructs && !findNode(_pr->ast, NodeType_StructDecl).empty()) {
+      const char* structTypeCode =
+      #include <qilang/detail/structtype.txt>
+      ;
+      out() << structTypeCode;
+      indent() << std::endl;
+    }
+    // libqi has no type interface for `std::array`.
+    if (!findNode(_pr->ast, NodeType_ArrayTypeExpr).empty()) {
+      const char* arrayTypeCode =
+      #include <qilang/detail/arraytype.txt>
+      ;
+      out() << arrayTypeCode;
+      indent() << std::endl;
+    }
+    if (!findNode(_pr->ast, NodeType_StreamTypeExpr).empty()) {
+      const char* streamCode =
+      #include <qilang/detail/stream.txt>
+      ;
+      out() << streamCode;
+      indent() << std::endl;
+    }
+    // Used by both the remote proxies and the local bindings, which include this header.
+    if (hasAnnotatedMembers(_pr->ast, "batch")) {
+      const char* batchCode =
+      #include <qilang/detail/batch.txt>
+      ;
+      out() << batchCode;
+      indent() << std::endl;
+    }
+    if (hasAnnotatedMembers(_pr->ast, "pure") || hasAnnotatedMembers(_pr->ast, "cached")
+        || hasAnnotatedMembers(_pr->ast, "idempotent")) {
+      const char* cacheCode =
+      #include <qilang/detail/cache.txt>
+      ;
+      out() << cacheCode;
+      indent() << std::endl;
+    }
+    if (hasAnnotatedMembers(_pr->ast, "timeout")) {
+      const char* deadlineCode =
+      #include <qilang/detail/deadline.txt>
+      ;
+      out() << deadlineCode;
+      indent() << std::endl;
+    }
+    if (_options.instrument && !findNode(_pr->ast, NodeType_InterfaceDecl).empty()) {
+      const char* instrumentCode =
+      #include <qilang/detail/instrument.txt>
+      ;
+      out() << instrumentCode;
+      indent() << std::endl;
+    }
+    if (_options.trace && !findNode(_pr->ast, NodeType_InterfaceDecl).empty()) {
+      const char* traceCode =
+      #include <qilang/detail/trace.txt>
+      ;
+      out() << traceCode;
+      indent() << std::endl;
+    }
+    if (_options.probes && !findNode(_pr->ast, NodeType_InterfaceDecl).empty()) {
+      const char* probeCode =
+      #include <qilang/detail/probe.txt>
+      ;
+      out() << probeCode;
+      indent() << std::endl;
+    }
+    if (hasAnnotatedMembers(_pr->ast, "filterable")) {
+      const char* filterCode =
+      #include <qilang/detail/filter.txt>
+      ;
+      out() << filterCode;
+      indent() << std::endl;
+    }
+    if (hasAnnotatedMembers(_pr->ast, "coalesce") || hasAnnotatedMembers(_pr->ast, "deadband")) {
+      const char* throttleCode =
+      #include <qilang/detail/throttle.txt>
+      ;
+      out() << throttleCode;
+      indent() << std::endl;
+    }
+    if (hasMirroredProperties(_pr->ast)) {
+      const char* propertyCode =
+      #include <qilang/detail/property.txt>
+      ;
+      out() << propertyCode;
+      indent() << std::endl;
+    }
+  }
+
+  bool usesBuiltinType(BuiltinType type) const {
+    NodePtrVector builtins = findNode(_pr->ast, NodeType_BuiltinTypeExpr);
+    for (unsigned i = 0; i < builtins.size(); ++i) {
+      if (static_cast<BuiltinTypeExprNode*>(builtins.at(i).get())->builtinType == type)
+        return true;
+    }
+    return false;
   }
 
   void formatFooter() override {
@@ -503,9 +1043,10 @@ protected:
 
 };
 
-std::string genCppObjectInterface(const PackageManagerPtr& pm, const ParseResultPtr& pr) {
+std::string genCppObjectInterface(const PackageManagerPtr& pm, const ParseResultPtr& pr,
+                                  const CodegenOptions& options) {
   StringVector sv = extractCppIncludeDir(pm, pr, false);
-  return QiLangGenObjectDef(pm, pr, sv).format(pr->ast);
+  return QiLangGenObjectDef(pm, pr, sv, options).format(pr->ast);
 }
 
 }
@@ -7,12 +7,14 @@
 
 #include <iostream>
 #include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/foreach.hpp>
 #include <qi/log.hpp>
 #include <qilang/node.hpp>
 #include <qilang/formatter.hpp>
 #include <qilang/visitor.hpp>
 #include <qilang/docparser.hpp>
+#include <qilang/parser.hpp>
 #include <qi/os.hpp>
 #include "formatter_p.hpp"
 #include "cpptype.hpp"
@@ -26,14 +28,16 @@ namespace qilang {
   class QiLangGenObjectLocalAsync: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
   {
   public:
-    QiLangGenObjectLocalAsync(std::stringstream& ss, int indent)
+    QiLangGenObjectLocalAsync(std::stringstream& ss, int indent, const CodegenOptions& options)
       : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss, indent)
+      , _options(options)
     {}
 
     std::string selfName;
 
     void visitDecl(InterfaceDeclNode* node) {
       selfName = node->name;
+      _method = 0;
       indent() << "template <typename ImplPtr>" << std::endl;
       indent() << "class " << node->name << "LocalAsync : public " << node->name << "Async" << std::endl;
       indent() << "{" << std::endl;
@@ -42,11 +46,18 @@ namespace qilang {
         ScopedIndent _(_indent);
         indent() << "explicit " << node->name << "LocalAsync(ImplPtr impl)" << std::endl;
         indent() << "  : _p(std::move(impl))" << std::endl;
+        if (_options.instrument) {
+          indent() << "  , _stats(std::make_shared< ::qilang::detail::MethodStatsTable >("
+                   << cppMethodStatsNames(node).size() << "))" << std::endl;
+        }
         indent() << "{}" << std::endl;
+        formatDeadlineOverloads(node);
 
         for (unsigned int i = 0; i < node->values.size(); ++i) {
           accept(node->values.at(i));
         }
+        if (_options.instrument)
+          formatMethodStatsAccessors(node);
       }
 
       out() << std::endl;
@@ -55,6 +66,8 @@ namespace qilang {
         ScopedIndent _(_indent);
         indent() << "ImplPtr _p;" << std::endl;
         indent() << "using ImplType = typename ImplPtr::element_type;" << std::endl;
+        if (_options.instrument)
+          indent() << "std::shared_ptr< ::qilang::detail::MethodStatsTable > _stats;" << std::endl;
       }
 
       indent() << "};" << std::endl;
@@ -95,28 +108,79 @@ namespace qilang {
         outputArgs(CppParamsFormat_NameOnly);
         out() << "));" << std::endl;
 
-        // Use `qilang::detail::safeMemberAsync()` for asynchronicity, tryUnwrap to fallback on a simple future,
-        // whatever the return type of the member function of the implementation.
-        // @see `qilang::detail::safeMemberAsync()` for details.
-        indent() << "return qi::detail::tryUnwrap(qilang::detail::safeMemberAsync<ReturnType, ImplType>(f, _p";
-        outputArgs(CppParamsFormat_NameOnly);
-        out() << "));" << std::endl;
+        formatWrappedCall(node, cppCallWrappers(_options, selfName, node, _method));
       }
       indent() << "}" << std::endl << std::endl; // let an empty line after function definition
+      ++_method;
+    }
+
+    void formatWrappedCall(FnDeclNode* node, const StringVector& wrappers, std::size_t depth = 0) {
+      if (depth < wrappers.size()) {
+        indent() << "return " << wrappers.at(depth) << std::endl;
+        {
+          ScopedIndent _(_indent);
+          formatWrappedCall(node, wrappers, depth + 1);
+        }
+        indent() << "});" << std::endl;
+        return;
+      }
+      // Use `qilang::detail::safeMemberAsync()` for asynchronicity, tryUnwrap to fallback on a simple future,
+      // whatever the return type of the member function of the implementation.
+      // @see `qilang::detail::safeMemberAsync()` for details.
+      // Traced, the implementation is called in the span of the call, wherever it runs.
+      indent() << "return qi::detail::tryUnwrap(qilang::detail::safeMemberAsync<ReturnType, ImplType>("
+               << (_options.trace ? "::qilang::detail::inCurrentTraceSpan(f)" : "f") << ", _p";
+      if (!node->args.empty()) {
+        out() << ", ";
+        cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+      }
+      out() << "));" << std::endl;
     }
 
     void visitDecl(SigDeclNode*) {}
     void visitDecl(PropDeclNode*) {}
+
+  private:
+    // The calls of `@timeout` methods are only failed at the deadlines given by their callers,
+    // by the overloads of the interface that the methods of the binding would hide.
+    void formatDeadlineOverloads(InterfaceDeclNode* node) {
+      const StringVector names = cppTimeoutMethodNames(node);
+      for (unsigned int i = 0; i < names.size(); ++i)
+        indent() << "using " << node->name << "Async::" << names.at(i) << ";" << std::endl;
+    }
+
+    // The calls of all the methods go through the async binding, which counts them.
+    void formatMethodStatsAccessors(InterfaceDeclNode* node) {
+      const StringVector names = cppMethodStatsNames(node);
+      const std::string accessor = cppMethodStatsAccessor(node->name);
+      indent() << node->name << "MethodStats " << accessor << "() const override" << std::endl;
+      indent() << "{" << std::endl;
+      indent() << "  " << node->name << "MethodStats stats;" << std::endl;
+      for (unsigned int i = 0; i < names.size(); ++i)
+        indent() << "  stats." << names.at(i) << " = _stats->at(" << i << ").snapshot();" << std::endl;
+      indent() << "  return stats;" << std::endl;
+      indent() << "}" << std::endl << std::endl;
+      indent() << "void " << cppPrefixedName("reset", accessor) << "() override" << std::endl;
+      indent() << "{" << std::endl;
+      indent() << "  _stats->reset();" << std::endl;
+      indent() << "}" << std::endl;
+    }
+
+    const CodegenOptions _options;
+    // index of the visited method among the ones of its interface
+    unsigned int _method = 0;
   };
 
   class QiLangGenObjectLocalSync: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
   {
   public:
-    QiLangGenObjectLocalSync(std::stringstream& ss, int indent)
+    QiLangGenObjectLocalSync(std::stringstream& ss, int indent, bool instrument)
       : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss, indent)
+      , _instrument(instrument)
     {}
 
     void visitDecl(InterfaceDeclNode* node) {
+      _ifaceName = node->name;
       indent() << "template <typename ImplPtr>" << std::endl;
       indent() << "class " << node->name << "LocalSync : public " << node->name << ", public qi::Proxy" << std::endl;
       indent() << "{" << std::endl;
@@ -133,21 +197,30 @@ namespace qilang {
                 first = false;
               else
                 out() << ", ";
-              out() << "impl->" << boost::static_pointer_cast<SigDeclNode>(node->values.at(i))->name;
+              SigDeclNode* sig = static_cast<SigDeclNode*>(node->values.at(i).get());
+              out() << (isThrottled(sig) ? "_" : "impl->") << sig->name << (isThrottled(sig) ? "Throttled" : "");
             }
             if (node->values.at(i)->type() == NodeType_PropDecl) {
               if (first)
                 first = false;
               else
                 out() << ", ";
-              out() << "impl->" << boost::static_pointer_cast<PropDeclNode>(node->values.at(i))->name;
+              PropDeclNode* prop = static_cast<PropDeclNode*>(node->values.at(i).get());
+              out() << (isThrottled(prop) ? "_" : "impl->") << prop->name << (isThrottled(prop) ? "Throttled" : "");
             }
           }
         }
         out() << ")" << std::endl;
         indent() << "  , _async(impl)" << std::endl;
+        formatThrottleInits(node);
+        formatFilteredSubscriptionInits(node);
         indent() << "{}" << std::endl << std::endl;
 
+        // the deadline overloads of the interface, that the methods would hide
+        const StringVector deadlineOverloads = cppTimeoutMethodNames(node);
+        for (unsigned int i = 0; i < deadlineOverloads.size(); ++i)
+          indent() << "using " << node->name << "::" << deadlineOverloads.at(i) << ";" << std::endl;
+
         for (unsigned int i = 0; i < node->values.size(); ++i) {
           accept(node->values.at(i));
         }
@@ -157,6 +230,17 @@ namespace qilang {
         indent() << "{" << std::endl;
         indent() << "  return *static_cast<" << node->name << "Async*>(&_async);" << std::endl;
         indent() << "}" << std::endl;
+        if (_instrument) {
+          const std::string accessor = cppMethodStatsAccessor(node->name);
+          indent() << node->name << "MethodStats " << accessor << "() const override" << std::endl;
+          indent() << "{" << std::endl;
+          indent() << "  return _async." << accessor << "();" << std::endl;
+          indent() << "}" << std::endl;
+          indent() << "void " << cppPrefixedName("reset", accessor) << "() override" << std::endl;
+          indent() << "{" << std::endl;
+          indent() << "  _async." << cppPrefixedName("reset", accessor) << "();" << std::endl;
+          indent() << "}" << std::endl;
+        }
       }
 
       out() << std::endl;
@@ -164,12 +248,130 @@ namespace qilang {
       {
         ScopedIndent _(_indent);
         indent() << node->name << "LocalAsync<ImplPtr> _async;" << std::endl;
+        formatThrottleDecls(node);
+        formatFilteredSubscriptionDecls(node);
       }
 
       indent() << "};" << std::endl;
       indent() << std::endl;
     }
 
+    // `@coalesce` signals and `@deadband` properties are exposed as members relaying some of the
+    // emissions of the implementation, through a throttle declared after them so that it is
+    // destroyed first.
+    static bool isThrottled(SigDeclNode* node) {
+      qi::uint64_t periodMs;
+      return cppCoalescePeriod(node, periodMs);
+    }
+
+    static bool isThrottled(PropDeclNode* node) {
+      double band;
+      return cppDeadband(node, band);
+    }
+
+    void formatThrottleInits(InterfaceDeclNode* node) {
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() != NodeType_PropDecl)
+          continue;
+        PropDeclNode* prop = static_cast<PropDeclNode*>(node->values.at(i).get());
+        if (isThrottled(prop)) {
+          indent() << "  , _" << prop->name << "Throttled(::qilang::detail::deadbandGetter(_" << prop->name << "Throttle), "
+                   << "::qilang::detail::deadbandSetter(_" << prop->name << "Throttle))" << std::endl;
+        }
+      }
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() == NodeType_SigDecl) {
+          SigDeclNode* sig = static_cast<SigDeclNode*>(node->values.at(i).get());
+          qi::uint64_t periodMs;
+          if (cppCoalescePeriod(sig, periodMs)) {
+            indent() << "  , _" << sig->name << "Throttle(impl->" << sig->name << ", _" << sig->name
+                     << "Throttled, qi::MilliSeconds(" << periodMs << "))" << std::endl;
+          }
+        }
+        if (node->values.at(i)->type() == NodeType_PropDecl) {
+          PropDeclNode* prop = static_cast<PropDeclNode*>(node->values.at(i).get());
+          double band;
+          if (cppDeadband(prop, band)) {
+            indent() << "  , _" << prop->name << "Throttle(impl->" << prop->name << ", _" << prop->name
+                     << "Throttled, " << boost::lexical_cast<std::string>(band) << ")" << std::endl;
+          }
+        }
+      }
+    }
+
+    void formatThrottleDecls(InterfaceDeclNode* node) {
+      ScopedFormatAttrBlock _(constattr);
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() == NodeType_SigDecl) {
+          SigDeclNode* sig = static_cast<SigDeclNode*>(node->values.at(i).get());
+          if (!isThrottled(sig))
+            continue;
+          indent() << "::qi::Signal< ";
+          cppParamsFormat(this, sig->args, CppParamsFormat_TypeOnly);
+          out() << " > _" << sig->name << "Throttled;" << std::endl;
+        }
+        if (node->values.at(i)->type() == NodeType_PropDecl) {
+          PropDeclNode* prop = static_cast<PropDeclNode*>(node->values.at(i).get());
+          if (!isThrottled(prop))
+            continue;
+          indent() << "::qi::Property< ";
+          cppParamsFormat(this, prop->args, CppParamsFormat_TypeOnly);
+          out() << " > _" << prop->name << "Throttled;" << std::endl;
+        }
+      }
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() == NodeType_SigDecl) {
+          SigDeclNode* sig = static_cast<SigDeclNode*>(node->values.at(i).get());
+          if (!isThrottled(sig))
+            continue;
+          indent() << "::qilang::detail::SignalCoalescer< ";
+          cppParamsFormat(this, sig->args, CppParamsFormat_TypeOnly);
+          out() << " > _" << sig->name << "Throttle;" << std::endl;
+        }
+        if (node->values.at(i)->type() == NodeType_PropDecl) {
+          PropDeclNode* prop = static_cast<PropDeclNode*>(node->values.at(i).get());
+          if (!isThrottled(prop))
+            continue;
+          indent() << "::qilang::detail::PropertyDeadband< ";
+          cppParamsFormat(this, prop->args, CppParamsFormat_TypeOnly);
+          out() << " > _" << prop->name << "Throttle;" << std::endl;
+        }
+      }
+    }
+
+    // The remote subscribers of `@filterable` signals are declared after the signals, so that
+    // they are disconnected first.
+    void formatFilteredSubscriptionInits(InterfaceDeclNode* node) {
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() != NodeType_SigDecl)
+          continue;
+        SigDeclNode* sig = static_cast<SigDeclNode*>(node->values.at(i).get());
+        StringVector parameters;
+        if (cppFilterableParameters(sig, parameters))
+          indent() << "  , _" << sig->name << "Subscriptions(" << sig->name << ")" << std::endl;
+      }
+    }
+
+    void formatFilteredSubscriptionDecls(InterfaceDeclNode* node) {
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() != NodeType_SigDecl)
+          continue;
+        SigDeclNode* sig = static_cast<SigDeclNode*>(node->values.at(i).get());
+        StringVector parameters;
+        if (!cppFilterableParameters(sig, parameters))
+          continue;
+        formatFilteredSubscriptionsType(sig);
+        out() << " _" << sig->name << "Subscriptions;" << std::endl;
+      }
+    }
+
+    void formatFilteredSubscriptionsType(SigDeclNode* node) {
+      ScopedFormatAttrBlock _(constattr);
+      indent() << "::qilang::detail::FilteredSubscriptions< ";
+      cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+      out() << " >";
+    }
+
     void visitDecl(FnDeclNode* node) {
       indent();
       accept(node->effectiveRet());
@@ -191,15 +393,153 @@ namespace qilang {
       }
       indent() << "}" << std::endl;
     }
-    void visitDecl(SigDeclNode* node) {}
+
+    // The filters of `@filterable` signals are evaluated here, for the local subscribers and,
+    // through the subscription methods of the binding, for the remote ones.
+    void visitDecl(SigDeclNode* node) {
+      StringVector parameters;
+      if (!cppFilterableParameters(node, parameters))
+        return;
+      const std::string filterName = cppSignalFilterName(_ifaceName, node);
+      indent() << "::qi::Future< ::qi::SignalLink > " << cppPrefixedName("connect", node->name) << "(const "
+               << filterName << "& filter, ::boost::function< void(";
+      {
+        ScopedFormatAttrBlock _(constattr);
+        cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+      }
+      out() << ") > subscriber)" << std::endl;
+      indent() << "{" << std::endl;
+      indent() << "  return ::qilang::detail::connectFiltered(" << node->name << ", filter.clauses(), " << filterName
+               << "::parameters(), std::move(subscriber));" << std::endl;
+      indent() << "}" << std::endl;
+      indent() << "::qi::Future< void > " << cppPrefixedName("disconnect", node->name) << "(::qi::SignalLink link)"
+               << std::endl;
+      indent() << "{" << std::endl;
+      indent() << "  " << node->name << ".disconnect(link);" << std::endl;
+      indent() << "  return ::qi::Future< void >{ nullptr };" << std::endl;
+      indent() << "}" << std::endl;
+      formatFilteredSubscriptionsType(node);
+      out() << "& " << node->name << "Subscriptions()" << std::endl;
+      indent() << "{" << std::endl;
+      indent() << "  return _" << node->name << "Subscriptions;" << std::endl;
+      indent() << "}" << std::endl;
+    }
     void visitDecl(PropDeclNode* node) {}
+
+  private:
+    std::string _ifaceName;
+    bool _instrument;
+  };
+
+  // Signature of the parameters of `node`, empty if it depends on how a type is registered in C++.
+  static std::string paramsSignature(FnDeclNode* node) {
+    std::string signature = "(";
+    for (unsigned i = 0; i < node->args.size(); ++i) {
+      const ParamFieldDeclNodePtr& param = node->args.at(i);
+      if (param->paramType != ParamFieldType_Normal)
+        return std::string();
+      for (unsigned j = 0; j < param->names.size(); ++j) {
+        if (!qiLangToSignature(param->effectiveType(), signature))
+          return std::string();
+      }
+    }
+    signature += ")";
+    return signature;
+  }
+
+  // Signature of the return of `node`, empty if it depends on how a type is registered in C++.
+  static std::string returnSignature(FnDeclNode* node) {
+    std::string signature;
+    if (!qiLangToSignature(node->effectiveRet(), signature))
+      return std::string();
+    return signature;
+  }
+
+  // Constant tables of the metadata of the methods of an interface, used by REGISTER_X.
+  // Everything known at generation time (names, documentation, signatures) is computed here
+  // instead of at registration time.
+  class QiLangGenObjectMethodTable: public NodeFormatter<DefaultNodeVisitor>
+  {
+  public:
+    QiLangGenObjectMethodTable(std::stringstream& ss, int indent)
+      : NodeFormatter<DefaultNodeVisitor>(ss, indent)
+    {}
+
+    std::string _curName;
+    unsigned int _fnIndex;
+    std::stringstream _parameters;
+    std::stringstream _methods;
+
+    static std::string cstr(const boost::optional<std::string>& str) {
+      if (!str)
+        return "nullptr";
+      return "\"" + *str + "\"";
+    }
+
+    void visitDecl(InterfaceDeclNode* node) {
+      _curName = node->name;
+      _fnIndex = 0;
+      _parameters.str(std::string());
+      _methods.str(std::string());
+      {
+        ScopedIndent _(_indent);
+        for (unsigned int i = 0; i < node->values.size(); ++i) {
+          accept(node->values.at(i));
+        }
+      }
+      if (_fnIndex == 0)
+        return;
+
+      indent() << "namespace detail {" << std::endl;
+      out() << _parameters.str();
+      {
+        ScopedIndent _(_indent);
+        indent() << "inline constexpr ::qilang::detail::MethodInfo " << _curName << "Methods[] = {" << std::endl;
+        out() << _methods.str();
+        indent() << "};" << std::endl;
+      }
+      indent() << "}" << std::endl << std::endl;
+    }
+
+    void visitDecl(FnDeclNode* node) {
+      const unsigned int index = _fnIndex++;
+      Doc doc = parseDoc(node->comment());
+
+      std::string parameters = "nullptr";
+      if (!doc.parameters.empty()) {
+        parameters = _curName + "MethodParameters" + boost::lexical_cast<std::string>(index);
+        _parameters << std::string(_indent, ' ') << "inline constexpr ::qilang::detail::MethodParameterInfo "
+          << parameters << "[] = {" << std::endl;
+        BOOST_FOREACH(Doc::Parameters::value_type it, doc.parameters) {
+          _parameters << std::string(_indent + 2, ' ') << "{ \"" << it.first << "\", \"" << it.second << "\" },"
+            << std::endl;
+        }
+        _parameters << std::string(_indent, ' ') << "};" << std::endl;
+      }
+
+      boost::optional<std::string> params;
+      boost::optional<std::string> ret;
+      std::string signature = paramsSignature(node);
+      if (!signature.empty())
+        params = signature;
+      signature = returnSignature(node);
+      if (!signature.empty())
+        ret = signature;
+
+      _methods << std::string(_indent + 2, ' ') << "{ \"" << node->name << "\", " << cstr(params) << ", " << cstr(ret)
+        << ", " << cstr(doc.description) << ", " << cstr(doc.return_) << ", " << parameters
+        << ", " << doc.parameters.size() << " }," << std::endl;
+    }
+    void visitDecl(SigDeclNode*) {}
+    void visitDecl(PropDeclNode*) {}
   };
 
   class QiLangGenObjectBind: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
   {
   public:
-    QiLangGenObjectBind(std::stringstream& ss, const StringVector& ns)
+    QiLangGenObjectBind(std::stringstream& ss, const StringVector& ns, bool trace)
       : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss)
+      , _trace(trace)
     {
       BOOST_FOREACH(const std::string& nspart, ns) {
         _ns += "::" + nspart;
@@ -209,11 +549,14 @@ namespace qilang {
     std::string _ns;
     std::string _curName;
     std::string _fullName;
+    unsigned int _fnIndex;
     FormatAttr _methodBounceAttr;
+    const bool _trace;
 
     void visitDecl(InterfaceDeclNode* node) {
       _fullName = _ns + "::" + node->name;
       _curName = node->name;
+      _fnIndex = 0;
 
 
       indent() << "#define REGISTER_" << boost::to_upper_copy<std::string>(node->name) << "(" << ImplTypeName << ") \\" << std::endl;
@@ -232,21 +575,23 @@ namespace qilang {
           accept(node->values.at(i));
         }
       }
-      indent() << "static int initType" << node->name << "() { \\" << std::endl;
+      indent() << "static void initType" << node->name << "() { \\" << std::endl;
       {
         ScopedIndent _(_indent);
         indent() << "qi::ObjectTypeBuilder< " << _fullName << " > builder; \\" << std::endl;
         for (unsigned int i = 0; i < node->inherits.size(); ++i) {
+          indent() << "::qilang::detail::TypeRegistry::ensureRegistered(typeid(" << node->inherits.at(i) << ")); \\" << std::endl;
           indent() << "builder.inherits< " << node->inherits.at(i) << " >(); \\" << std::endl;
         }
         for (unsigned int i = 0; i < node->values.size(); ++i) {
           accept(node->values.at(i));
         }
         indent() << "builder.registerType(); \\" << std::endl;
-        indent() << "return 42; \\" << std::endl;
       }
       indent() << "} \\" << std::endl;
-      indent() << "static int myinittype" << node->name << " = initType" << node->name << "();" << std::endl;
+      // Deferred until the first local object of that type is created.
+      indent() << "static bool myinittype" << node->name << " = ::qilang::detail::TypeRegistry::defer(typeid("
+        << _fullName << "), &initType" << node->name << ");" << std::endl;
       indent() << std::endl;
 
       _fullName.clear();
@@ -271,24 +616,22 @@ namespace qilang {
           out() << "); \\" << std::endl;
         }
         indent() << "} \\" << std::endl;
+        if (node->hasAnnotation("batch"))
+          formatBatchBounce(node);
+        if (_trace)
+          formatTracedBounce(node);
       }
       else {
         indent() << "{ \\" << std::endl;
         {
           ScopedIndent _(_indent);
-          Doc doc = parseDoc(node->comment());
-          indent() << "qi::MetaMethodBuilder mmb; \\" << std::endl;
-          indent() << "mmb.setName(\"" << node->name << "\"); \\" << std::endl;
-          BOOST_FOREACH(Doc::Parameters::value_type it, doc.parameters) {
-            indent() << "mmb.appendParameter(\"" << it.first << "\", \"" << it.second << "\"); \\" << std::endl;
-          }
-          if (doc.return_)
-            indent() << "mmb.setReturnDescription(\"" << *doc.return_ << "\"); \\" << std::endl;
-          if (doc.description)
-            indent() << "mmb.setDescription(\"" << *doc.description << "\"); \\" << std::endl;
           indent() << "const auto callType = std::is_base_of<qi::Actor, " << ImplTypeName << " >::value ?"
             " qi::MetaCallType_Direct : qi::MetaCallType_Auto; \\" << std::endl;
-          indent() << "builder.advertiseMethod(mmb, static_cast<::qi::Future< ";
+          // only the registration path fitting the signatures known by qicc is instantiated
+          const bool knownSignatures = !paramsSignature(node).empty() && !returnSignature(node).empty();
+          indent() << "::qilang::detail::" << (knownSignatures ? "advertiseSignedMethod" : "advertiseMethod")
+            << "(builder, " << _ns << "::detail::" << _curName << "Methods["
+            << _fnIndex++ << "], static_cast<::qi::Future< ";
           accept(node->effectiveRet());
           out() << " > (*)(" << _fullName << "*";
           if (!node->args.empty())
@@ -298,18 +641,125 @@ namespace qilang {
           }
           out() << ")>(&" << _curName << node->name;
           out() << "), callType); \\" << std::endl;
+          if (node->hasAnnotation("batch")) {
+            indent() << "builder.advertiseMethod(::qilang::detail::batchMethodName(\"" << node->name
+              << "\"), static_cast<";
+            formatBatchReturn(node);
+            out() << " (*)(" << _fullName << "*, ";
+            formatBatchCalls(node);
+            out() << ")>(&" << _curName << node->name << "Batch), callType); \\" << std::endl;
+          }
+          if (_trace) {
+            indent() << "builder.advertiseMethod(::qilang::detail::tracedMethodName(\"" << node->name
+              << "\"), static_cast<::qi::Future< ";
+            accept(node->effectiveRet());
+            out() << " > (*)(" << _fullName << "*, ::qi::uint64_t";
+            if (!node->args.empty())
+            {
+              out() << ", ";
+              cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+            }
+            out() << ")>(&" << _curName << node->name << "Traced), callType); \\" << std::endl;
+          }
         }
         indent() << "} \\" << std::endl;
       }
     }
 
+    // The batch entry point of a `@batch` method: calls the method once per call of the batch.
+    void formatBatchBounce(FnDeclNode* node) {
+      indent() << "static ";
+      formatBatchReturn(node);
+      out() << " " << _curName << node->name << "Batch(" << _fullName << "* obj, ";
+      formatBatchCalls(node);
+      out() << " calls) { \\" << std::endl;
+      {
+        ScopedIndent _(_indent);
+        indent() << "auto& async = static_cast<qi::detail::InterfaceImplTraits< " << _fullName
+          << " >::SyncType*>(obj)->async(); \\" << std::endl;
+        indent() << "return ::qilang::detail::batchCall< ";
+        accept(node->effectiveRet());
+        out() << " >(calls, [&async](";
+        cppParamsFormat(this, node->args);
+        out() << ") { return async." << node->name << "(";
+        cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+        out() << "); }); \\" << std::endl;
+      }
+      indent() << "} \\" << std::endl;
+    }
+
+    // The traced entry point of a method: calls it in the span of the remote caller, see
+    // `qilang::detail::tracedAsync()`.
+    void formatTracedBounce(FnDeclNode* node) {
+      indent() << "static ::qi::Future< ";
+      accept(node->effectiveRet());
+      out() << " > " << _curName << node->name << "Traced(" << _fullName << "* obj, ::qi::uint64_t parent";
+      if (!node->args.empty()) {
+        out() << ", ";
+        cppParamsFormat(this, node->args);
+      }
+      out() << ") { \\" << std::endl;
+      {
+        ScopedIndent _(_indent);
+        indent() << "::qilang::detail::ScopedTraceSpan scope(parent); \\" << std::endl;
+        indent() << "return static_cast<qi::detail::InterfaceImplTraits< " << _fullName
+          << " >::SyncType*>(obj)->async()." << node->name << "(";
+        cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+        out() << "); \\" << std::endl;
+      }
+      indent() << "} \\" << std::endl;
+    }
+
+    void formatBatchReturn(FnDeclNode* node) {
+      out() << "::qi::Future< ::qilang::detail::BatchResults< ";
+      accept(node->effectiveRet());
+      out() << " > >";
+    }
+
+    void formatBatchCalls(FnDeclNode* node) {
+      out() << "const std::vector< std::tuple< ";
+      {
+        ScopedFormatAttrBlock _(constattr);
+        cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+      }
+      out() << " > >&";
+    }
+
     void visitDecl(SigDeclNode* node) {
-      if (!_methodBounceAttr.isActive()) {
-        indent() << "builder.advertiseSignal(\"" << node->name << "\", &" << _fullName << "::_" << node->name
-          << "); \\" << std::endl;
+      StringVector parameters;
+      const bool filterable = cppFilterableParameters(node, parameters);
+      if (_methodBounceAttr.isActive()) {
+        if (filterable)
+          formatFilterBounces(node);
+        return;
+      }
+      indent() << "builder.advertiseSignal(\"" << node->name << "\", &" << _fullName << "::_" << node->name
+        << "); \\" << std::endl;
+      if (filterable) {
+        indent() << "builder.advertiseMethod(::qilang::detail::filterSubscribeMethodName(\"" << node->name << "\"), &"
+          << _curName << node->name << "Subscribe); \\" << std::endl;
+        indent() << "builder.advertiseMethod(::qilang::detail::filterUnsubscribeMethodName(\"" << node->name << "\"), &"
+          << _curName << node->name << "Unsubscribe); \\" << std::endl;
       }
     }
 
+    // The entry points of the remote subscribers of a `@filterable` signal, whose filter is
+    // evaluated before anything is sent to them.
+    void formatFilterBounces(SigDeclNode* node) {
+      indent() << "static ::qi::Future< ::qi::SignalLink > " << _curName << node->name << "Subscribe(" << _fullName
+        << "* obj, const ::qilang::detail::SignalFilter& filter, const qi::AnyObject& receiver) { \\" << std::endl;
+      indent() << "  return ::qi::Future< ::qi::SignalLink >{ static_cast<qi::detail::InterfaceImplTraits< " << _fullName
+        << " >::SyncType*>(obj)->" << node->name << "Subscriptions().subscribe(filter, " << _ns << "::"
+        << cppSignalFilterName(_curName, node) << "::parameters(), receiver) }; \\" << std::endl;
+      indent() << "} \\" << std::endl;
+      indent() << "static ::qi::Future< void > " << _curName << node->name << "Unsubscribe(" << _fullName
+        << "* obj, ::qi::SignalLink link) { \\" << std::endl;
+      // only the subscribers connected by the subscription method can be disconnected
+      indent() << "  return static_cast<qi::detail::InterfaceImplTraits< " << _fullName << " >::SyncType*>(obj)->"
+        << node->name << "Subscriptions().unsubscribe(link); \\" << std::endl;
+      indent() << "} \\" << std::endl;
+    }
+
     void visitDecl(PropDeclNode* node) {
       if (!_methodBounceAttr.isActive()) {
         indent() << "builder.advertiseProperty(\"" << node->name << "\", &" << _fullName << "::_" << node->name
@@ -326,25 +776,29 @@ namespace qilang {
     StringVector _includes;
     StringVector _ns;
 
-    QiLangGenObjects(StringVector includes, std::string packageName, std::string fileName)
+    QiLangGenObjects(StringVector includes, std::string packageName, std::string fileName,
+                     const CodegenOptions& options)
       : toclose(0)
       , _includes(includes)
       , _packageName(std::move(packageName))
       , _fileName(fileName)
+      , _options(options)
     {
       _includes.push_back("<boost/smart_ptr/enable_shared_from_raw.hpp>");
       _includes.push_back("<qi/assert.hpp>");
     }
 
     void visitDecl(InterfaceDeclNode* node) {
-      QiLangGenObjectLocalAsync locasync(out(), _indent);
+      QiLangGenObjectLocalAsync locasync(out(), _indent, _options);
       node->accept(&locasync);
-      QiLangGenObjectLocalSync locsync(out(), _indent);
+      QiLangGenObjectLocalSync locsync(out(), _indent, _options.instrument);
       node->accept(&locsync);
+      QiLangGenObjectMethodTable table(out(), _indent);
+      node->accept(&table);
 
       closeNamespace();
 
-      QiLangGenObjectBind bind(out(), _ns);
+      QiLangGenObjectBind bind(out(), _ns, _options.trace);
       node->accept(&bind);
 
       openNamespace();
@@ -405,10 +859,12 @@ namespace qilang {
   private:
     const std::string _packageName;
     const std::string _fileName;
+    const CodegenOptions _options;
   };
 
-std::string genCppObjectLocal(const PackageManagerPtr& pm, const ParseResultPtr& pr) {
+std::string genCppObjectLocal(const PackageManagerPtr& pm, const ParseResultPtr& pr,
+                              const CodegenOptions& options) {
   StringVector sv = extractCppIncludeDir(pm, pr, true);
-  return QiLangGenObjects(sv, pr->package, pr->filename).format(pr->ast);
+  return QiLangGenObjects(sv, pr->package, pr->filename, options).format(pr->ast);
 }
 }
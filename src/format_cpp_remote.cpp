@@ -22,11 +22,14 @@ namespace qilang {
   class CppAsyncRemoteQiLangGen: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
   {
   public:
-    CppAsyncRemoteQiLangGen(std::stringstream& ss, int indent)
+    CppAsyncRemoteQiLangGen(std::stringstream& ss, int indent, const CodegenOptions& options)
       : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss, indent)
+      , _options(options)
     {}
 
     void visitDecl(InterfaceDeclNode* node) {
+      _ifaceName = node->name;
+      _method = 0;
       indent() << "class " << node->name + "AsyncRemote" << ": public " << node->name << "Async";
       //there is some inherits, so proxy is already inherited by the parent.
       if (node->inherits.size() > 0) {
@@ -50,11 +53,22 @@ namespace qilang {
           }
         }
         out() << "_obj(ao)" << std::endl;
-        indent() << "{}" << std::endl;
+        {
+          ScopedIndent _(_indent);
+          formatHelperInits(node);
+          if (_options.instrument) {
+            indent() << ", _stats(std::make_shared< ::qilang::detail::MethodStatsTable >("
+                     << cppMethodStatsNames(node).size() << "))" << std::endl;
+          }
+        }
+        formatInvalidations(node);
 
         for (unsigned int i = 0; i < node->values.size(); ++i) {
+          _index = i;
           accept(node->values.at(i));
         }
+        if (_options.instrument)
+          formatMethodStatsAccessors(node);
       }
 
       out() << std::endl;
@@ -62,6 +76,9 @@ namespace qilang {
       {
         ScopedIndent _(_indent);
         indent() << "qi::AnyObject _obj;" << std::endl;
+        formatHelperDecls(node);
+        if (_options.instrument)
+          indent() << "std::shared_ptr< ::qilang::detail::MethodStatsTable > _stats;" << std::endl;
       }
 
       indent() << "};" << std::endl;
@@ -69,28 +86,258 @@ namespace qilang {
     }
 
     void visitDecl(FnDeclNode* node) {
+      qi::uint64_t timeoutMs = 0;
+      const bool timeout = cppTimeout(node, timeoutMs);
+      if (timeout) {
+        // the calls are made by the overload taking their deadline
+        indent() << "::qi::Future< ";
+        accept(node->effectiveRet());
+        out() << " > " << node->name << "(";
+        cppParamsFormat(this, node->args);
+        out() << ") {" << std::endl;
+        indent() << "  return " << node->name << "(";
+        cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+        out() << (node->args.empty() ? "" : ", ") << "::qi::SteadyClock::now() + ::qi::MilliSeconds(" << timeoutMs
+              << "));" << std::endl;
+        indent() << "}" << std::endl;
+      }
       indent() << "::qi::Future< ";
       accept(node->effectiveRet());
       out() << " > " << node->name << "(";
       cppParamsFormat(this, node->args);
+      if (timeout)
+        out() << (node->args.empty() ? "" : ", ") << "::qi::SteadyClockTimePoint deadline";
       out() << ") {" << std::endl;
       {
         ScopedIndent _(_indent);
-        indent() << "return _obj.async< ";
-        accept(node->effectiveRet());
-        out() << " >(";
-        out() << "\"" << node->name << "\"";
-        if (node->args.size() != 0)
-          out() << ", ";
-        cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
-        out() << ");" << std::endl;
+        // the calls are counted, traced and probed as made by the caller, whether they reach the service or not
+        formatWrappedBody(node, cppCallWrappers(_options, _ifaceName, node, _method));
       }
       indent() << "}" << std::endl;
+      ++_method;
+    }
+
+    void formatWrappedBody(FnDeclNode* node, const StringVector& wrappers, std::size_t depth = 0) {
+      if (depth == wrappers.size()) {
+        formatDeadlineBody(node);
+        return;
+      }
+      indent() << "return " << wrappers.at(depth) << std::endl;
+      {
+        ScopedIndent _(_indent);
+        formatWrappedBody(node, wrappers, depth + 1);
+      }
+      indent() << "});" << std::endl;
+    }
+
+    // `@timeout` calls fail at their deadline, and are canceled then
+    void formatDeadlineBody(FnDeclNode* node) {
+      qi::uint64_t timeoutMs = 0;
+      if (!cppTimeout(node, timeoutMs)) {
+        formatBody(node);
+        return;
+      }
+      indent() << "return ::qilang::detail::withDeadline(deadline, [&] {" << std::endl;
+      {
+        ScopedIndent _(_indent);
+        formatBody(node);
+      }
+      indent() << "});" << std::endl;
+    }
+
+    void formatBody(FnDeclNode* node) {
+      CppBatchOptions batch;
+      CppCacheOptions cache;
+      if (cppBatchOptions(node, batch)) {
+        // gathered with the calls made around the same time into a single call
+        indent() << "return " << helperName(node, "Batcher", _index) << "->call(std::make_tuple(";
+        cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+        out() << "));" << std::endl;
+      } else if (cppCacheOptions(node, cache)) {
+        // the call is only made if its result is not known
+        indent() << "return " << helperName(node, "Cache", _index) << "->get(std::make_tuple(";
+        formatArgNames(node->args);
+        out() << "), [&] {" << std::endl;
+        {
+          ScopedIndent _(_indent);
+          formatCall(node);
+        }
+        indent() << "});" << std::endl;
+      } else if (node->hasAnnotation("idempotent")) {
+        // the call is only made if no identical one is pending
+        indent() << "return " << helperName(node, "Flight", _index) << "->call(std::make_tuple(";
+        formatArgNames(node->args);
+        out() << "), [&] {" << std::endl;
+        {
+          ScopedIndent _(_indent);
+          formatCall(node);
+        }
+        indent() << "});" << std::endl;
+      } else {
+        formatCall(node);
+      }
+    }
+
+    void formatCall(FnDeclNode* node) {
+      // traced, the span of the call is passed to the service, which makes it the parent of its own
+      indent() << "return " << (_options.trace ? "::qilang::detail::tracedAsync< " : "_obj.async< ");
+      accept(node->effectiveRet());
+      out() << " >(" << (_options.trace ? "_obj, " : "");
+      out() << "\"" << node->name << "\"";
+      if (node->args.size() != 0)
+        out() << ", ";
+      cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+      out() << ");" << std::endl;
     }
+
     void visitDecl(SigDeclNode* node) {
     }
     void visitDecl(PropDeclNode* node) {
     }
+
+  private:
+    // The calls of all the methods of the sync proxy go through this one, which counts them.
+    void formatMethodStatsAccessors(InterfaceDeclNode* node) {
+      const StringVector names = cppMethodStatsNames(node);
+      const std::string accessor = cppMethodStatsAccessor(node->name);
+      indent() << node->name << "MethodStats " << accessor << "() const override {" << std::endl;
+      indent() << "  " << node->name << "MethodStats stats;" << std::endl;
+      for (unsigned int i = 0; i < names.size(); ++i)
+        indent() << "  stats." << names.at(i) << " = _stats->at(" << i << ").snapshot();" << std::endl;
+      indent() << "  return stats;" << std::endl;
+      indent() << "}" << std::endl;
+      indent() << "void " << cppPrefixedName("reset", accessor) << "() override {" << std::endl;
+      indent() << "  _stats->reset();" << std::endl;
+      indent() << "}" << std::endl;
+    }
+
+    const CodegenOptions _options;
+    std::string _ifaceName;
+    // index of the visited member in its interface
+    unsigned int _index = 0;
+    // index of the visited method among the ones of its interface
+    unsigned int _method = 0;
+
+    // methods can be overloaded: the helpers of a method are named after its index too
+    static std::string helperName(FnDeclNode* node, const std::string& helper, unsigned int index) {
+      return "_" + node->name + helper + std::to_string(index);
+    }
+
+    // Members of the proxy helping with the calls of some methods: `@batch` methods have a
+    // batcher, `@pure` and `@cached` ones a cache of their results, `@idempotent` ones the
+    // calls they have pending.
+    void formatHelperDecls(InterfaceDeclNode* node) {
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() != NodeType_FnDecl)
+          continue;
+        FnDeclNode* fn = static_cast<FnDeclNode*>(node->values.at(i).get());
+        CppBatchOptions batch;
+        CppCacheOptions cache;
+        if (cppBatchOptions(fn, batch)) {
+          indent() << "std::shared_ptr< ";
+          formatBatcherType(fn);
+          out() << " > " << helperName(fn, "Batcher", i) << ";" << std::endl;
+        } else if (cppCacheOptions(fn, cache)) {
+          indent() << "std::shared_ptr< ";
+          formatCacheType(fn);
+          out() << " > " << helperName(fn, "Cache", i) << ";" << std::endl;
+        } else if (fn->hasAnnotation("idempotent")) {
+          indent() << "std::shared_ptr< ";
+          formatFlightType(fn);
+          out() << " > " << helperName(fn, "Flight", i) << ";" << std::endl;
+        }
+      }
+    }
+
+    void formatHelperInits(InterfaceDeclNode* node) {
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() != NodeType_FnDecl)
+          continue;
+        FnDeclNode* fn = static_cast<FnDeclNode*>(node->values.at(i).get());
+        CppBatchOptions batch;
+        CppCacheOptions cache;
+        if (cppBatchOptions(fn, batch)) {
+          indent() << ", " << helperName(fn, "Batcher", i) << "(std::make_shared< ";
+          formatBatcherType(fn);
+          out() << " >(ao, \"" << fn->name << "\", qi::MilliSeconds(" << batch.windowMs << "), "
+                << batch.maxCount << "))" << std::endl;
+        } else if (cppCacheOptions(fn, cache)) {
+          indent() << ", " << helperName(fn, "Cache", i) << "(std::make_shared< ";
+          formatCacheType(fn);
+          out() << " >(qi::MilliSeconds(" << cache.ttlMs << ")))" << std::endl;
+        } else if (fn->hasAnnotation("idempotent")) {
+          indent() << ", " << helperName(fn, "Flight", i) << "(std::make_shared< ";
+          formatFlightType(fn);
+          out() << " >())" << std::endl;
+        }
+      }
+    }
+
+    // Body of the constructor: caches are cleared by the signals invalidating them.
+    void formatInvalidations(InterfaceDeclNode* node) {
+      bool empty = true;
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() != NodeType_FnDecl)
+          continue;
+        FnDeclNode* fn = static_cast<FnDeclNode*>(node->values.at(i).get());
+        CppCacheOptions cache;
+        if (!cppCacheOptions(fn, cache) || cache.invalidatedBy.empty())
+          continue;
+        if (empty)
+          indent() << "{" << std::endl;
+        empty = false;
+        ScopedIndent _(_indent);
+        indent() << helperName(fn, "Cache", i) << "->invalidateOn(ao, \"" << cache.invalidatedBy << "\");" << std::endl;
+      }
+      indent() << (empty ? "{}" : "}") << std::endl;
+    }
+
+    void formatArgNames(const ParamFieldDeclNodePtrVector& args) {
+      for (unsigned int i = 0; i < args.size(); ++i) {
+        for (unsigned int j = 0; j < args.at(i)->names.size(); ++j) {
+          if (i + j != 0)
+            out() << ", ";
+          out() << detail::toName(args.at(i)->names.at(j), i);
+        }
+      }
+    }
+
+    void formatCacheType(FnDeclNode* node) {
+      out() << "::qilang::detail::ResultCache< ";
+      accept(node->effectiveRet());
+      out() << ", ";
+      formatCallKeyType(node);
+      out() << " >";
+    }
+
+    void formatFlightType(FnDeclNode* node) {
+      out() << "::qilang::detail::SingleFlight< ";
+      accept(node->effectiveRet());
+      out() << ", ";
+      formatCallKeyType(node);
+      out() << " >";
+    }
+
+    // the calls are told apart by the values of their arguments
+    void formatCallKeyType(FnDeclNode* node) {
+      out() << "::qilang::detail::CallKey< ";
+      {
+        ScopedFormatAttrBlock _(constattr);
+        cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+      }
+      out() << " >";
+    }
+
+    void formatBatcherType(FnDeclNode* node) {
+      out() << "::qilang::detail::Batcher< ";
+      accept(node->effectiveRet());
+      if (node->args.size() != 0) {
+        out() << ", ";
+        ScopedFormatAttrBlock _(constattr);
+        cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+      }
+      out() << " >";
+    }
   };
 
   class CppProxySigPropQiLangGen: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
@@ -105,7 +352,9 @@ namespace qilang {
       indent() << "qi::makeProxySignal(_" << node->name << ", ao, \"" << node->name << "\");" << std::endl;
     }
     void visitDecl(PropDeclNode* node) {
-      indent() << "qi::makeProxyProperty(_" << node->name << ", ao, \"" << node->name << "\");" << std::endl;
+      // the others are mirrored, see CppSyncRemoteQiLangGen
+      if (!cppMirrorsProperty(node))
+        indent() << "qi::makeProxyProperty(_" << node->name << ", ao, \"" << node->name << "\");" << std::endl;
     }
   };
 
@@ -134,11 +383,13 @@ namespace qilang {
   class CppSyncRemoteQiLangGen: public CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >
   {
   public:
-    CppSyncRemoteQiLangGen(std::stringstream& ss, int indent)
+    CppSyncRemoteQiLangGen(std::stringstream& ss, int indent, const CodegenOptions& options)
       : CppTypeFormatter<NodeFormatter<DefaultNodeVisitor> >(ss, indent)
+      , _options(options)
     {}
 
     void visitDecl(InterfaceDeclNode* node) {
+      _ifaceName = node->name;
       indent() << "class " << node->name + "Remote" << ": public " << node->name;
       //there is some inherits, so proxy is already inherited by the parent.
       if (node->inherits.size() == 0) {
@@ -186,7 +437,9 @@ namespace qilang {
           }
           out() << ")" << std::endl;
           indent() << ", qi::Proxy(ao)" << std::endl;
+          formatMirroredProperties(node);
           indent() << ", _async(ao)" << std::endl;
+          formatMirrorInits(node);
         }
         indent() << "{" << std::endl;
         {
@@ -197,6 +450,11 @@ namespace qilang {
         }
         indent() << "}" << std::endl;
 
+        // the deadline overloads of the interface, that the methods would hide
+        const StringVector deadlineOverloads = cppTimeoutMethodNames(node);
+        for (unsigned int i = 0; i < deadlineOverloads.size(); ++i)
+          indent() << "using " << node->name << "::" << deadlineOverloads.at(i) << ";" << std::endl;
+
         for (unsigned int i = 0; i < node->values.size(); ++i) {
           accept(node->values.at(i));
         }
@@ -207,6 +465,15 @@ namespace qilang {
           indent() << "return _async;" << std::endl;
         }
         indent() << "}" << std::endl;
+        if (_options.instrument) {
+          const std::string accessor = cppMethodStatsAccessor(node->name);
+          indent() << node->name << "MethodStats " << accessor << "() const override {" << std::endl;
+          indent() << "  return _async." << accessor << "();" << std::endl;
+          indent() << "}" << std::endl;
+          indent() << "void " << cppPrefixedName("reset", accessor) << "() override {" << std::endl;
+          indent() << "  _async." << cppPrefixedName("reset", accessor) << "();" << std::endl;
+          indent() << "}" << std::endl;
+        }
       }
 
       out() << std::endl;
@@ -218,6 +485,7 @@ namespace qilang {
         node->accept(&decl);
 
         indent() << node->name << "AsyncRemote _async;" << std::endl;
+        formatMirrorDecls(node);
       }
 
       indent() << "};" << std::endl;
@@ -233,19 +501,32 @@ namespace qilang {
       out() << ") {" << std::endl;
       {
         ScopedIndent _(_indent);
-        if (!node->hasNoReturn())
+        if (_options.instrument || _options.trace || _options.probes || node->hasAnnotation("batch")
+            || node->hasAnnotation("pure") || node->hasAnnotation("cached") || node->hasAnnotation("idempotent")
+            || node->hasAnnotation("timeout"))
         {
-          indent() << "return _obj.call< ";
-          accept(node->ret);
-          out() << " >(";
+          // only the async proxy gathers the calls in batches, caches their results, shares them,
+          // counts them, traces them, probes them or fails them at their deadline
+          indent() << (node->hasNoReturn() ? "" : "return ") << "_async." << node->name << "(";
+          cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+          out() << ").value();" << std::endl;
         }
         else
-          indent() << "_obj.call<void>(";
-        out() << "\"" << node->name << "\"";
-        if (node->args.size() != 0)
-          out() << ", ";
-        cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
-        out() << ");" << std::endl;
+        {
+          if (!node->hasNoReturn())
+          {
+            indent() << "return _obj.call< ";
+            accept(node->ret);
+            out() << " >(";
+          }
+          else
+            indent() << "_obj.call<void>(";
+          out() << "\"" << node->name << "\"";
+          if (node->args.size() != 0)
+            out() << ", ";
+          cppParamsFormat(this, node->args, CppParamsFormat_NameOnly);
+          out() << ");" << std::endl;
+        }
       }
       indent() << "}" << std::endl;
     }
@@ -260,6 +541,23 @@ namespace qilang {
         indent() << "return _" << node->name << ";" << std::endl;
       }
       indent() << "}" << std::endl;
+
+      StringVector parameters;
+      if (!cppFilterableParameters(node, parameters))
+        return;
+      // the filter is sent to the service, which only notifies the emissions passing it
+      indent() << "::qi::Future< ::qi::SignalLink > " << cppPrefixedName("connect", node->name) << "(const "
+               << cppSignalFilterName(_ifaceName, node) << "& filter, ::boost::function< void(";
+      cppParamsFormat(this, node->args, CppParamsFormat_TypeOnly);
+      out() << ") > subscriber) {" << std::endl;
+      indent() << "  return ::qilang::detail::connectRemoteFiltered(_obj, \"" << node->name
+               << "\", filter.clauses(), std::move(subscriber));" << std::endl;
+      indent() << "}" << std::endl;
+      indent() << "::qi::Future< void > " << cppPrefixedName("disconnect", node->name) << "(::qi::SignalLink link) {"
+               << std::endl;
+      indent() << "  return _obj.async< void >(::qilang::detail::filterUnsubscribeMethodName(\"" << node->name
+               << "\"), link);" << std::endl;
+      indent() << "}" << std::endl;
     }
     void visitDecl(PropDeclNode* node) {
       indent() << "::qi::Property< ";
@@ -272,14 +570,63 @@ namespace qilang {
       }
       indent() << "}" << std::endl;
     }
+
+  private:
+    // Properties are read from a copy of their value, kept by a mirror declared after them
+    // so that it is destroyed first, and subscribing once the property is read or subscribed to.
+    // `@uncached` ones are plain proxy properties.
+    static std::vector<PropDeclNode*> mirroredProperties(InterfaceDeclNode* node) {
+      std::vector<PropDeclNode*> props;
+      for (unsigned int i = 0; i < node->values.size(); ++i) {
+        if (node->values.at(i)->type() != NodeType_PropDecl)
+          continue;
+        PropDeclNode* prop = static_cast<PropDeclNode*>(node->values.at(i).get());
+        if (cppMirrorsProperty(prop))
+          props.push_back(prop);
+      }
+      return props;
+    }
+
+    void formatMirroredProperties(InterfaceDeclNode* node) {
+      std::vector<PropDeclNode*> props = mirroredProperties(node);
+      for (unsigned int i = 0; i < props.size(); ++i) {
+        PropDeclNode* prop = props.at(i);
+        indent() << ", _" << prop->name << "(::qilang::detail::mirrorGetter(_" << prop->name << "Mirror), "
+                 << "::qilang::detail::mirrorSetter(_" << prop->name << "Mirror), "
+                 << "::qilang::detail::mirrorOnSubscribers(_" << prop->name << "Mirror))" << std::endl;
+      }
+    }
+
+    void formatMirrorInits(InterfaceDeclNode* node) {
+      std::vector<PropDeclNode*> props = mirroredProperties(node);
+      for (unsigned int i = 0; i < props.size(); ++i) {
+        PropDeclNode* prop = props.at(i);
+        indent() << ", _" << prop->name << "Mirror(_" << prop->name << ", ao, \"" << prop->name << "\")" << std::endl;
+      }
+    }
+
+    void formatMirrorDecls(InterfaceDeclNode* node) {
+      std::vector<PropDeclNode*> props = mirroredProperties(node);
+      for (unsigned int i = 0; i < props.size(); ++i) {
+        PropDeclNode* prop = props.at(i);
+        indent() << "::qilang::detail::PropertyMirror< ";
+        ScopedFormatAttrBlock _(constattr);
+        cppParamsFormat(this, prop->args, CppParamsFormat_TypeOnly);
+        out() << " > _" << prop->name << "Mirror;" << std::endl;
+      }
+    }
+
+    std::string _ifaceName;
+    const CodegenOptions _options;
   };
 
   //Generate Type Registration Information
   class CppRemoteQiLangGen: public CppTypeFormatter<>
   {
   public:
-    CppRemoteQiLangGen(const PackageManagerPtr& pm, const StringVector& includes)
+    CppRemoteQiLangGen(const PackageManagerPtr& pm, const StringVector& includes, const CodegenOptions& options)
       : _includes(includes)
+      , _options(options)
     {}
 
     void doAccept(Node* node) override { node->accept(this); }
@@ -288,9 +635,9 @@ namespace qilang {
     StringVector _includes;
 
     void visitDecl(InterfaceDeclNode* node) override {
-      CppAsyncRemoteQiLangGen ar(out(), _indent);
+      CppAsyncRemoteQiLangGen ar(out(), _indent, _options);
       node->accept(&ar);
-      CppSyncRemoteQiLangGen ir(out(), _indent);
+      CppSyncRemoteQiLangGen ir(out(), _indent, _options);
       node->accept(&ir);
       {
         ScopedNamespaceEscaper _e(out(), currentNs);
@@ -376,11 +723,14 @@ namespace qilang {
     throw std::runtime_error("unimplemented");
   }
 
+private:
+  const CodegenOptions _options;
 };
 
-std::string genCppObjectRemote(const PackageManagerPtr& pm, const ParseResultPtr& pr) {
+std::string genCppObjectRemote(const PackageManagerPtr& pm, const ParseResultPtr& pr,
+                               const CodegenOptions& options) {
   StringVector sv = extractCppIncludeDir(pm, pr, true);
-  return CppRemoteQiLangGen(pm, sv).format(pr->ast);
+  return CppRemoteQiLangGen(pm, sv, options).format(pr->ast);
 }
 
 }
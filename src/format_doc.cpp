@@ -81,6 +81,8 @@ static std::string builtinTypeToString(BuiltinType type) {
     return "str";
   case BuiltinType_Raw:
     return "raw";
+  case BuiltinType_RawView:
+    return "rawview";
   case BuiltinType_Value:
     return "any";
   case BuiltinType_Object:
@@ -260,6 +262,16 @@ public:
   virtual void visitTypeExpr(MapTypeExprNode* node) {}
   virtual void visitTypeExpr(TupleTypeExprNode* node) {}
   virtual void visitTypeExpr(OptionalTypeExprNode* node) {}
+  virtual void visitTypeExpr(ArrayTypeExprNode* node) {
+    out() << "Array<";
+    accept(node->element);
+    out() << ", " << node->size << ">";
+  }
+  virtual void visitTypeExpr(StreamTypeExprNode* node) {
+    out() << "Stream<";
+    accept(node->element);
+    out() << ">";
+  }
   virtual void visitTypeExpr(VarArgTypeExprNode *node) {}
   virtual void visitTypeExpr(KeywordArgTypeExprNode *node) {}
 
@@ -0,0 +1,78 @@
+#include <iomanip>
+#include <sstream>
+#include <qilang/node.hpp>
+#include <qilang/visitor.hpp>
+#include <qilang/formatter.hpp>
+#include <qilang/packagemanager.hpp>
+#include "cpptype.hpp"
+
+qiLogCategory("qigen.layout");
+
+namespace qilang {
+
+static std::size_t padding(const CppStructMemberVector& members, const CppLayout& layout) {
+  std::size_t used = 0;
+  for (unsigned i = 0; i < members.size(); ++i)
+    used += members.at(i).layout.size;
+  return layout.size - used;
+}
+
+static void formatStructLayout(std::ostream& out, const PackageManagerPtr& pm, const std::string& package,
+                               const StructDeclNode* node, bool reorder) {
+  CppLayout declared, reordered;
+  const CppStructMemberVector declaredMembers = cppStructLayout(pm, node, false, declared);
+  const CppStructMemberVector reorderedMembers = cppStructLayout(pm, node, true, reordered);
+  const CppStructMemberVector& members = reorder ? reorderedMembers : declaredMembers;
+  const CppLayout& layout = reorder ? reordered : declared;
+
+  out << "struct " << package << "." << node->name << " (" << node->loc().filename << ")" << std::endl;
+  out << "  declared order: sizeof " << declared.size << ", alignment " << declared.align
+      << ", padding " << padding(declaredMembers, declared) << std::endl;
+  out << "  reordered:      sizeof " << reordered.size << ", alignment " << reordered.align
+      << ", padding " << padding(reorderedMembers, reordered) << std::endl;
+  out << "  " << (reorder ? "reordered" : "declared order") << " members:" << std::endl;
+  out << "    offset  size  align  padding  member" << std::endl;
+  std::size_t end = 0;
+  for (unsigned i = 0; i < members.size(); ++i) {
+    const CppStructMember& member = members.at(i);
+    out << "    " << std::setw(6) << member.offset
+        << "  " << std::setw(4) << member.layout.size
+        << "  " << std::setw(5) << member.layout.align
+        << "  " << std::setw(7) << member.offset - end
+        << "  " << member.name << " " << format(member.field->effectiveType()) << std::endl;
+    end = member.offset + member.layout.size;
+  }
+  if (layout.size != end)
+    out << "    " << std::setw(6) << end << "  " << std::setw(4) << "" << "  " << std::setw(5) << ""
+        << "  " << std::setw(7) << layout.size - end << "  (tail padding)" << std::endl;
+  out << std::endl;
+}
+
+std::string genLayoutReport(const PackageManagerPtr& pm, const ParseResultPtr& pr, const CodegenOptions& options) {
+  std::stringstream out;
+  out << "# Layout of the structs of package " << pr->package << std::endl;
+  out << "# Estimated for a 64-bit target with libstdc++, sizes and offsets in bytes." << std::endl;
+  out << std::endl;
+
+  NodePtrVector structs;
+  PackagePtr pkg = pm->package(pr->package);
+  StringVector files;
+  if (pkg)
+    files = pkg->files();
+  if (files.empty()) {
+    structs = findNode(pr->ast, NodeType_StructDecl);
+  } else {
+    for (unsigned i = 0; i < files.size(); ++i) {
+      NodePtrVector fileStructs = findNode(pm->ast(files.at(i)), NodeType_StructDecl);
+      structs.insert(structs.end(), fileStructs.begin(), fileStructs.end());
+    }
+  }
+
+  for (unsigned i = 0; i < structs.size(); ++i) {
+    formatStructLayout(out, pm, pr->package, static_cast<StructDeclNode*>(structs.at(i).get()),
+                       options.reorderStructFields);
+  }
+  return out.str();
+}
+
+}
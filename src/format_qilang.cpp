@@ -38,7 +38,10 @@ namespace qilang {
         out() << "false";
     }
     void visitData(IntLiteralNode *node) {
-      out() << node->value;
+      if (node->negative())
+        out() << static_cast<qi::int64_t>(node->value);
+      else
+        out() << node->value;
     }
     void visitData(FloatLiteralNode *node) {
       out() << node->value;
@@ -87,6 +90,15 @@ namespace qilang {
       out() << "+"; // like in libqi
       accept(node->element);
     }
+    void visitTypeExpr(ArrayTypeExprNode *node) {
+      out() << "[" << node->size << "]";
+      accept(node->element);
+    }
+    void visitTypeExpr(StreamTypeExprNode *node) {
+      out() << "Stream<";
+      accept(node->element);
+      out() << ">";
+    }
     void visitTypeExpr(VarArgTypeExprNode* node) {
       accept(node->effectiveElement());
     }
@@ -140,6 +152,24 @@ namespace qilang {
       out() << std::endl << std::endl;
     }
 
+    void printAnnotation(const Annotation& annotation) {
+      out() << "@" << annotation.name;
+      if (!annotation.args.empty()) {
+        out() << "(";
+        join(annotation.args, ", ");
+        out() << ")";
+      }
+    }
+
+    // one per line, before the declaration
+    void declAnnotations(const DeclNode* node) {
+      for (unsigned i = 0; i < node->annotations.size(); ++i) {
+        indent();
+        printAnnotation(node->annotations.at(i));
+        out() << std::endl;
+      }
+    }
+
     void printInherits(const StringVector& inherits) {
       if (inherits.size() > 0) {
         out() << "(";
@@ -157,15 +187,22 @@ namespace qilang {
     }
 
     void visitDecl(FnDeclNode* node) {
+      declAnnotations(node);
       declParamList("fn", node->name, node->comment(), node->args, node->ret);
     }
     void visitDecl(SigDeclNode* node) {
+      declAnnotations(node);
       declParamList("emit", node->name, node->args);
     }
     void visitDecl(PropDeclNode* node) {
+      declAnnotations(node);
       declParamList("prop", node->name, node->args);
     }
     void visitDecl(ParamFieldDeclNode* node) {
+      for (unsigned i = 0; i < node->annotations.size(); ++i) {
+        printAnnotation(node->annotations.at(i));
+        out() << " ";
+      }
       if (node->isVarArgs())
         out() << "*";
       if (node->isKeywordArgs())
@@ -184,6 +221,10 @@ namespace qilang {
     }
 
     void visitDecl(StructDeclNode* node) {
+      // generated from its `@columns` struct
+      if (node->hasAnnotation("columnsof"))
+        return;
+      declAnnotations(node);
       indent() << "struct " << node->name;
       printInherits(node->inherits);
       out() << std::endl;
@@ -211,7 +252,12 @@ namespace qilang {
     }
 
     void visitDecl(EnumDeclNode* node) {
-      indent() << "enum " << node->name << std::endl;
+      indent() << (node->flags ? "flags " : "enum ") << node->name;
+      if (node->underlyingType) {
+        out() << ": ";
+        accept(node->underlyingType);
+      }
+      out() << std::endl;
       scoped(node->fields);
       indent() << "end" << std::endl;
     }
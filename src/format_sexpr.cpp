@@ -38,7 +38,10 @@ namespace qilang {
       out() << "(bool " << node->value << ")";
     }
     void visitData(IntLiteralNode *node) {
-      out() << "(int " << node->value << ")";
+      if (node->negative())
+        out() << "(int " << static_cast<qi::int64_t>(node->value) << ")";
+      else
+        out() << "(int " << node->value << ")";
     }
     void visitData(FloatLiteralNode *node) {
       out() << "(float " << node->value << ")";
@@ -88,6 +91,16 @@ namespace qilang {
       accept(node->element);
       out() << ")";
     }
+    void visitTypeExpr(ArrayTypeExprNode *node) {
+      out() << "(arraytype ";
+      accept(node->element);
+      out() << " " << node->size << ")";
+    }
+    void visitTypeExpr(StreamTypeExprNode *node) {
+      out() << "(streamtype ";
+      accept(node->element);
+      out() << ")";
+    }
     void visitTypeExpr(VarArgTypeExprNode* node) {
       out() << "(varg ";
       accept(node->element);
@@ -123,6 +136,18 @@ namespace qilang {
       out() << ")";
     }
 
+    void printAnnotations(const DeclNode* node) {
+      for (unsigned i = 0; i < node->annotations.size(); ++i) {
+        const Annotation& annotation = node->annotations.at(i);
+        out() << "(annotation " << annotation.name;
+        if (!annotation.args.empty()) {
+          out() << " ";
+          join(annotation.args, " ");
+        }
+        out() << ")";
+      }
+    }
+
     void printInherit(const StringVector& inherits) {
       if (inherits.size() > 0) {
         out() << "(inherit ";
@@ -139,7 +164,7 @@ namespace qilang {
       indent() << ")" << std::endl;
     }
 
-    void declParamList(const std::string &declname, const std::string& name, const ParamFieldDeclNodePtrVector& vec, const TypeExprNodePtr &ret = TypeExprNodePtr()) {
+    void declParamList(const std::string &declname, const DeclNode* node, const std::string& name, const ParamFieldDeclNodePtrVector& vec, const TypeExprNodePtr &ret = TypeExprNodePtr()) {
       out() << "(" << declname << " " << name << "(";
       join(vec, " ");
       out() << ")";
@@ -147,6 +172,7 @@ namespace qilang {
         out() << " ";
         accept(ret);
       }
+      printAnnotations(node);
       out() << ")" << std::endl;
     }
 
@@ -163,20 +189,22 @@ namespace qilang {
         accept(node->type);
         out() << ")";
       }
+      printAnnotations(node);
       out() << ")";
     }
     void visitDecl(FnDeclNode* node) {
-      declParamList("fn", node->name, node->args, node->ret);
+      declParamList("fn", node, node->name, node->args, node->ret);
     }
     void visitDecl(SigDeclNode* node) {
-      declParamList("emit", node->name, node->args);
+      declParamList("emit", node, node->name, node->args);
     }
     void visitDecl(PropDeclNode* node) {
-      declParamList("prop", node->name, node->args);
+      declParamList("prop", node, node->name, node->args);
     }
     void visitDecl(StructDeclNode* node) {
       indent() << "(struct " << node->name;
       printInherit(node->inherits);
+      printAnnotations(node);
       out() << std::endl;
       scoped(node->decls);
       indent() << ")" << std::endl;
@@ -203,7 +231,12 @@ namespace qilang {
       out() << ")" << std::endl;
     }
     void visitDecl(EnumDeclNode* node) {
-      indent() << "(enum " << node->name << std::endl;
+      indent() << (node->flags ? "(flags " : "(enum ") << node->name;
+      if (node->underlyingType) {
+        out() << " ";
+        accept(node->underlyingType);
+      }
+      out() << std::endl;
       scoped(node->fields);
       indent() << ")" << std::endl;
     }
@@ -6,6 +6,7 @@
 */
 
 %{
+#include <algorithm>
 #include <cstdio>
 #include <sstream>
 #include <string>
@@ -13,6 +14,7 @@
 #include <map>
 #include <stdexcept>
 #include <boost/make_shared.hpp>
+#include <qilang/formatter.hpp>
 #include <qilang/node.hpp>
 #include <qilang/parser.hpp>
 #include "parser_p.hpp"
@@ -87,7 +89,7 @@
       "float32", "float64",
       "nsec", "usec", "msec", "sec", "min", "hour",
       "qitimepoint", "steadytimepoint", "systemtimepoint",
-      "str", "raw", "any", "obj", 0 };
+      "str", "raw", "rawview", "any", "obj", 0 };
     int index = 0;
     const char *t = builtin[index];
     while (t != 0) {
@@ -99,6 +101,329 @@
     return NODE1(CustomTypeExprNode, loc, id);
   }
 
+  bool isIntegralType(const qilang::TypeExprNodePtr& type) {
+    if (type->type() != qilang::NodeType_BuiltinTypeExpr)
+      return false;
+    const qilang::BuiltinType builtin = static_cast<qilang::BuiltinTypeExprNode*>(type.get())->builtinType;
+    return builtin >= qilang::BuiltinType_Char && builtin <= qilang::BuiltinType_UInt64;
+  }
+
+  // number of bits available for flags in an integral type
+  unsigned int flagBits(const qilang::TypeExprNodePtr& type) {
+    switch (static_cast<qilang::BuiltinTypeExprNode*>(type.get())->builtinType) {
+      case qilang::BuiltinType_Char:
+      case qilang::BuiltinType_Int8:   return 7;
+      case qilang::BuiltinType_UInt8:  return 8;
+      case qilang::BuiltinType_Int16:  return 15;
+      case qilang::BuiltinType_UInt16: return 16;
+      case qilang::BuiltinType_Int64:  return 63;
+      case qilang::BuiltinType_UInt64: return 64;
+      case qilang::BuiltinType_Int:
+      case qilang::BuiltinType_Int32:  return 31;
+      default:                         return 32;
+    }
+  }
+
+  // `flags` are enums whose fields are successive powers of two.
+  qilang::DeclNodePtr makeFlags(const yy::location& loc, const std::string& name,
+                                const qilang::TypeExprNodePtr& type, const qilang::StringVector& ids) {
+    qilang::EnumFieldDeclNodePtrVector fields;
+    for (unsigned i = 0; i < ids.size(); ++i) {
+      qilang::LiteralNodePtr value = NODE1(IntLiteralNode, loc, qi::uint64_t(1) << i);
+      fields.push_back(NODE2(EnumFieldDeclNode, loc, qilang::EnumFieldType_Const, NODE2(ConstDeclNode, loc, ids.at(i), value)));
+    }
+    boost::shared_ptr<qilang::EnumDeclNode> decl = NODE3(EnumDeclNode, loc, name, type, fields);
+    decl->flags = true;
+    return decl;
+  }
+
+  // see qilang::evalConstExpr
+  qilang::LiteralNodePtr fold(const yy::location& loc, const qilang::ExprNodePtr& expr) {
+    try {
+      return qilang::evalConstExpr(expr);
+    } catch (const std::runtime_error& e) {
+      throw qilang::ParseException(qilang::makeLocation(loc), e.what());
+    }
+  }
+
+  qilang::LiteralNodePtr foldUnary(const yy::location& loc, qilang::UnaryOpCode op, const qilang::LiteralNodePtr& operand) {
+    qilang::ExprNodePtr expr = NODE1(LiteralExprNode, loc, operand);
+    return fold(loc, NODE2(UnaryOpExprNode, loc, expr, op));
+  }
+
+  qilang::LiteralNodePtr foldBinary(const yy::location& loc, qilang::BinaryOpCode op,
+                                    const qilang::LiteralNodePtr& left, const qilang::LiteralNodePtr& right) {
+    qilang::ExprNodePtr l = NODE1(LiteralExprNode, loc, left);
+    qilang::ExprNodePtr r = NODE1(LiteralExprNode, loc, right);
+    return fold(loc, NODE3(BinaryOpExprNode, loc, l, r, op));
+  }
+
+  // throw if `value` cannot initialize a constant of type `type`
+  void checkConst(const yy::location& loc, const qilang::TypeExprNodePtr& type, const qilang::LiteralNodePtr& value) {
+    const std::string error = qilang::checkConstType(type, value);
+    if (!error.empty())
+      throw qilang::ParseException(qilang::makeLocation(loc), error);
+  }
+
+  // annotations are parsed right to left: prepend to keep the declaration order
+  template <typename T>
+  T annotate(const T& decl, const qilang::Annotation& annotation) {
+    decl->annotations.insert(decl->annotations.begin(), annotation);
+    return decl;
+  }
+
+  bool isCount(const qilang::LiteralNodePtr& arg) {
+    return arg->type() == qilang::NodeType_IntData && !static_cast<qilang::IntLiteralNode*>(arg.get())->negative();
+  }
+
+  // whether the property holds a single integer or floating point value
+  bool isNumericProperty(const qilang::PropDeclNode* prop) {
+    if (prop->args.size() != 1 || prop->args.at(0)->names.size() != 1)
+      return false;
+    const qilang::TypeExprNodePtr& type = prop->args.at(0)->type;
+    if (!type || type->type() != qilang::NodeType_BuiltinTypeExpr)
+      return false;
+    const qilang::BuiltinType builtin = static_cast<qilang::BuiltinTypeExprNode*>(type.get())->builtinType;
+    return builtin >= qilang::BuiltinType_Int && builtin <= qilang::BuiltinType_Float64;
+  }
+
+  // the declarations an annotation applies to, null for unknown annotations
+  const char* annotationTarget(const std::string& name) {
+    if (name == "sink")
+      return "parameters of methods";
+    if (name == "columns")
+      return "structs";
+    if (name == "uncached" || name == "deadband")
+      return "properties";
+    if (name == "coalesce" || name == "filterable")
+      return "signals";
+    if (name == "batch" || name == "pure" || name == "cached" || name == "idempotent" || name == "timeout")
+      return "methods";
+    return nullptr;
+  }
+
+  // throw if the annotation is unknown, or does not apply to declarations of `kinds`, among
+  // the ones given by annotationTarget
+  void checkAnnotationTarget(const yy::location& loc, const qilang::Annotation& annotation, const std::vector<std::string>& kinds) {
+    const char* target = annotationTarget(annotation.name);
+    if (!target)
+      throw qilang::ParseException(qilang::makeLocation(loc), "unknown annotation @" + annotation.name);
+    if (std::find(kinds.begin(), kinds.end(), target) == kinds.end())
+      throw qilang::ParseException(qilang::makeLocation(loc), "@" + annotation.name + " only applies to " + target);
+  }
+
+  // throw if the annotation of a parameter does not apply to it
+  void checkParamAnnotation(const yy::location& loc, const qilang::Annotation& annotation) {
+    checkAnnotationTarget(loc, annotation, {"parameters of methods"});
+    if (!annotation.args.empty())
+      throw qilang::ParseException(qilang::makeLocation(loc), "@" + annotation.name + " takes no arguments");
+  }
+
+  // throw if the annotation of a struct does not apply to it
+  void checkStructAnnotation(const yy::location& loc, const qilang::Annotation& annotation) {
+    checkAnnotationTarget(loc, annotation, {"structs"});
+    if (!annotation.args.empty())
+      throw qilang::ParseException(qilang::makeLocation(loc), "@" + annotation.name + " takes no arguments");
+  }
+
+  // throw if the annotation of an interface member does not apply to it
+  void checkMemberAnnotation(const yy::location& loc, const qilang::DeclNodePtr& decl, const qilang::Annotation& annotation) {
+    checkAnnotationTarget(loc, annotation, {"properties", "signals", "methods"});
+    const std::string& name = annotation.name;
+    if (name == "uncached") {
+      if (decl->type() != qilang::NodeType_PropDecl)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@uncached only applies to properties");
+      if (!annotation.args.empty())
+        throw qilang::ParseException(qilang::makeLocation(loc), "@uncached takes no arguments");
+      return;
+    }
+    if (name == "coalesce") {
+      if (decl->type() != qilang::NodeType_SigDecl)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@coalesce only applies to signals");
+      if (annotation.args.size() != 1 || !isCount(annotation.args.at(0))
+          || static_cast<qilang::IntLiteralNode*>(annotation.args.at(0).get())->value == 0)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@coalesce takes a positive period in milliseconds");
+      return;
+    }
+    if (name == "deadband") {
+      qilang::PropDeclNode* prop = dynamic_cast<qilang::PropDeclNode*>(decl.get());
+      if (!prop)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@deadband only applies to properties");
+      if (!isNumericProperty(prop))
+        throw qilang::ParseException(qilang::makeLocation(loc), "@deadband only applies to properties of a numeric type");
+      const bool isBand = annotation.args.size() == 1
+        && (isCount(annotation.args.at(0))
+            || (annotation.args.at(0)->type() == qilang::NodeType_FloatData
+                && static_cast<qilang::FloatLiteralNode*>(annotation.args.at(0).get())->value >= 0));
+      if (!isBand)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@deadband takes a non-negative number");
+      return;
+    }
+    if (name == "filterable") {
+      qilang::SigDeclNode* sig = dynamic_cast<qilang::SigDeclNode*>(decl.get());
+      if (!sig)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@filterable only applies to signals");
+      if (annotation.args.empty())
+        throw qilang::ParseException(qilang::makeLocation(loc), "@filterable takes the parameters that can be filtered on");
+      for (unsigned i = 0; i < annotation.args.size(); ++i) {
+        if (annotation.args.at(i)->type() != qilang::NodeType_StringData)
+          throw qilang::ParseException(qilang::makeLocation(loc), "@filterable takes names of parameters");
+        const std::string& param = static_cast<qilang::StringLiteralNode*>(annotation.args.at(i).get())->value;
+        bool found = false;
+        for (unsigned j = 0; j < sig->args.size() && !found; ++j) {
+          const qilang::ParamFieldDeclNodePtr& arg = sig->args.at(j);
+          found = arg->paramType == qilang::ParamFieldType_Normal
+               && std::find(arg->names.begin(), arg->names.end(), param) != arg->names.end();
+        }
+        if (!found)
+          throw qilang::ParseException(qilang::makeLocation(loc), "no parameter '" + param + "' in '" + sig->name + "' to filter on");
+      }
+      return;
+    }
+    qilang::FnDeclNode* fn = dynamic_cast<qilang::FnDeclNode*>(decl.get());
+    if (!fn)
+      throw qilang::ParseException(qilang::makeLocation(loc), "@" + name + " only applies to methods");
+
+    if (name == "batch") {
+      for (unsigned i = 0; i < fn->args.size(); ++i) {
+        if (fn->args.at(i)->paramType != qilang::ParamFieldType_Normal)
+          throw qilang::ParseException(qilang::makeLocation(loc), "@batch methods cannot take variadic arguments");
+      }
+      // @batch(window ms, max count)
+      if (annotation.args.size() > 2)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@batch takes at most a window in milliseconds and a maximum count");
+      for (unsigned i = 0; i < annotation.args.size(); ++i) {
+        if (!isCount(annotation.args.at(i)))
+          throw qilang::ParseException(qilang::makeLocation(loc), "@batch arguments must be non-negative integers");
+      }
+      return;
+    }
+
+    if (name == "idempotent") {
+      if (!annotation.args.empty())
+        throw qilang::ParseException(qilang::makeLocation(loc), "@idempotent takes no arguments");
+      return;
+    }
+
+    if (name == "timeout") {
+      if (annotation.args.size() != 1 || !isCount(annotation.args.at(0))
+          || static_cast<qilang::IntLiteralNode*>(annotation.args.at(0).get())->value == 0)
+        throw qilang::ParseException(qilang::makeLocation(loc), "@timeout takes a positive duration in milliseconds");
+      return;
+    }
+
+    // @pure and @cached(ttl ms[, invalidating signal])
+    if (fn->hasNoReturn())
+      throw qilang::ParseException(qilang::makeLocation(loc), "@" + name + " methods must return a value");
+    if (name == "pure") {
+      if (!annotation.args.empty())
+        throw qilang::ParseException(qilang::makeLocation(loc), "@pure takes no arguments");
+      return;
+    }
+    if (annotation.args.empty() || annotation.args.size() > 2)
+      throw qilang::ParseException(qilang::makeLocation(loc), "@cached takes a duration in milliseconds and optionally a signal");
+    if (!isCount(annotation.args.at(0)) || static_cast<qilang::IntLiteralNode*>(annotation.args.at(0).get())->value == 0)
+      throw qilang::ParseException(qilang::makeLocation(loc), "the duration of @cached must be a positive integer");
+    if (annotation.args.size() == 2 && annotation.args.at(1)->type() != qilang::NodeType_StringData)
+      throw qilang::ParseException(qilang::makeLocation(loc), "@cached results can only be invalidated by a signal");
+  }
+
+  // throw if the parameters of a signal or a property are annotated, which only applies to methods
+  void checkUnannotatedParams(const qilang::ParamFieldDeclNodePtrVector& params) {
+    for (unsigned i = 0; i < params.size(); ++i) {
+      if (!params.at(i)->annotations.empty()) {
+        const qilang::Annotation& annotation = params.at(i)->annotations.front();
+        throw qilang::ParseException(annotation.loc, "@" + annotation.name + " only applies to parameters of methods");
+      }
+    }
+  }
+
+  // the types of the parameters of a method, one per name, as written
+  std::vector<std::string> paramTypes(const qilang::FnDeclNode* fn) {
+    std::vector<std::string> types;
+    for (unsigned i = 0; i < fn->args.size(); ++i)
+      types.insert(types.end(), fn->args.at(i)->names.size(), qilang::format(fn->args.at(i)->effectiveType()));
+    return types;
+  }
+
+  // throw if a method overloads the one generated for the callers of a `@timeout` method to give
+  // their deadline, which takes the parameters of the method followed by a `steadytimepoint`
+  void checkDeadlineOverload(const qilang::DeclNodePtrVector& decls, const qilang::FnDeclNode* fn,
+                             const qilang::Location& loc) {
+    std::vector<std::string> deadline = paramTypes(fn);
+    deadline.push_back("steadytimepoint");
+    for (unsigned i = 0; i < decls.size(); ++i) {
+      if (decls.at(i)->type() != qilang::NodeType_FnDecl)
+        continue;
+      const qilang::FnDeclNode* other = static_cast<qilang::FnDeclNode*>(decls.at(i).get());
+      if (other->name == fn->name && paramTypes(other) == deadline)
+        throw qilang::ParseException(loc, "an overload of '" + fn->name + "' takes the parameters of the @timeout one followed by a "
+                                     "steadytimepoint, like the overload generated to give the deadline of its calls");
+    }
+  }
+
+  // throw if the annotations of the members of an interface do not fit together
+  void checkMembers(const qilang::DeclNodePtrVector& decls) {
+    for (unsigned i = 0; i < decls.size(); ++i) {
+      if (decls.at(i)->type() == qilang::NodeType_SigDecl)
+        checkUnannotatedParams(static_cast<qilang::SigDeclNode*>(decls.at(i).get())->args);
+      if (decls.at(i)->type() == qilang::NodeType_PropDecl)
+        checkUnannotatedParams(static_cast<qilang::PropDeclNode*>(decls.at(i).get())->args);
+      if (decls.at(i)->type() != qilang::NodeType_FnDecl)
+        continue;
+      qilang::FnDeclNode* fn = static_cast<qilang::FnDeclNode*>(decls.at(i).get());
+      const qilang::Annotation* idempotent = fn->annotation("idempotent");
+      if (idempotent && (fn->hasAnnotation("batch") || fn->hasAnnotation("pure") || fn->hasAnnotation("cached")))
+        throw qilang::ParseException(idempotent->loc, "@idempotent cannot be combined with @batch, @pure or @cached");
+      const qilang::Annotation* timeout = fn->annotation("timeout");
+      if (timeout)
+        checkDeadlineOverload(decls, fn, timeout->loc);
+      const qilang::Annotation* cached = fn->annotation("cached");
+      if (!cached)
+        cached = fn->annotation("pure");
+      if (!cached)
+        continue;
+      if (fn->hasAnnotation("batch"))
+        throw qilang::ParseException(cached->loc, "@batch methods cannot be cached");
+      if (cached->args.size() < 2)
+        continue;
+      const std::string& signal = static_cast<qilang::StringLiteralNode*>(cached->args.at(1).get())->value;
+      bool found = false;
+      for (unsigned j = 0; j < decls.size() && !found; ++j) {
+        found = decls.at(j)->type() == qilang::NodeType_SigDecl
+             && static_cast<qilang::SigDeclNode*>(decls.at(j).get())->name == signal;
+      }
+      if (!found)
+        throw qilang::ParseException(cached->loc, "no signal '" + signal + "' in the interface to invalidate the results of '" + fn->name + "'");
+    }
+  }
+
+  // `@columns struct X` is followed by its structure-of-arrays companion `XColumns`,
+  // with one `Vec` per field of `X`, annotated `@columnsof(X)`.
+  void pushToplevel(qilang::NodePtrVector& decls, const qilang::NodePtr& node) {
+    decls.push_back(node);
+    if (node->type() != qilang::NodeType_StructDecl)
+      return;
+    qilang::StructDeclNode* decl = static_cast<qilang::StructDeclNode*>(node.get());
+    const qilang::Annotation* columns = decl->annotation("columns");
+    if (!columns)
+      return;
+
+    qilang::DeclNodePtrVector fields;
+    for (unsigned i = 0; i < decl->decls.size(); ++i) {
+      qilang::StructFieldDeclNodePtr field = boost::dynamic_pointer_cast<qilang::StructFieldDeclNode>(decl->decls.at(i));
+      if (!field)
+        continue;
+      qilang::TypeExprNodePtr column = boost::make_shared<qilang::ListTypeExprNode>(field->effectiveType(), field->loc());
+      fields.push_back(boost::make_shared<qilang::StructFieldDeclNode>(field->names, column, field->loc()));
+    }
+    boost::shared_ptr<qilang::StructDeclNode> companion = boost::make_shared<qilang::StructDeclNode>(decl->name + "Columns", fields, decl->loc());
+    qilang::LiteralNodePtrVector args;
+    args.push_back(boost::make_shared<qilang::StringLiteralNode>(decl->name, columns->loc));
+    companion->annotations.push_back(qilang::Annotation("columnsof", args, columns->loc));
+    decls.push_back(companion);
+  }
+
 }
 
 %define api.token.prefix {TOK_}
@@ -114,6 +439,24 @@
   COMMA               ","
   COLON               ":"
   ARROW               "->"
+  AT                  "@"
+  LBRACKET            "["
+  RBRACKET            "]"
+  LBRACE              "{"
+  RBRACE              "}"
+  STARSTAR            "**"
+
+  // Operators of constant expressions
+  STAR                "*"
+  SLASH               "/"
+  PERCENT             "%"
+  PLUS                "+"
+  MINUS               "-"
+  PIPE                "|"
+  AMPERSAND           "&"
+  CARET               "^"
+  TILDE               "~"
+  BANG                "!"
 
   TRUE                "true"
   FALSE               "false"
@@ -129,6 +472,7 @@
 
   TYPEDEF             "typedef"
   ENUM                "enum"
+  FLAGS               "flags"
 
   // IFace Keywords
   SIG                 "sig"
@@ -140,6 +484,8 @@
   MAP                 "Map"
   TUPLE               "Tuple"
   OPT                 "Opt"
+  ARRAY               "Array"
+  STREAM              "Stream"
 
 %token <qilang::KeywordNodePtr>
   INTERFACE           "interface"
@@ -148,6 +494,13 @@
 %token <qilang::LiteralNodePtr>   STRING CONSTANT
 %token <std::string>              ID
 
+%left "|"
+%left "^"
+%left "&"
+%left "+" "-"
+%left "*" "/" "%"
+%precedence UNARY
+
 %%
 // #######################################################################################
 // # TOP LEVEL
@@ -162,8 +515,8 @@ toplevel:
 
 %type<qilang::NodePtrVector> toplevel.1;
 toplevel.1:
-  toplevel_def            { $$.push_back($1); }
-| toplevel.1 toplevel_def { std::swap($$, $1); $$.push_back($2); }
+  toplevel_def            { pushToplevel($$, $1); }
+| toplevel.1 toplevel_def { std::swap($$, $1); pushToplevel($$, $2); }
 
 %type<qilang::NodePtr> toplevel_def;
 toplevel_def:
@@ -175,12 +528,19 @@ toplevel_def:
 | struct        { $$ = $1; }
 | typedef       { $$ = $1; }
 | enums         { $$ = $1; }
+| flags         { $$ = $1; }
+
 
+// `flags` is only a keyword where a declaration starts: it can name fields, parameters and members.
+%type<std::string> name;
+name:
+  ID    { std::swap($$, $1); }
+| FLAGS { $$ = "flags"; }
 
 %type<qilang::StringVector> id_list;
 id_list:
-  ID             { $$.push_back($1); }
-| id_list "," ID { std::swap($$, $1); $$.push_back($3); }
+  name             { $$.push_back($1); }
+| id_list "," name { std::swap($$, $1); $$.push_back($3); }
 
 // #######################################################################################
 // # PACKAGE MANAGEMENT
@@ -202,6 +562,25 @@ import_defs:
 | import_defs "," ID               { std::swap($$, $1);
                                      $$.push_back($3); }
 
+// #######################################################################################
+// # ANNOTATION
+// #######################################################################################
+
+%type<qilang::Annotation> annotation;
+annotation:
+  "@" ID                           { $$ = qilang::Annotation($2, qilang::makeLocation(@$)); }
+| "@" ID "(" annotation_args ")"   { $$ = qilang::Annotation($2, $4, qilang::makeLocation(@$)); }
+
+%type<qilang::LiteralNodePtrVector> annotation_args;
+annotation_args:
+  annotation_arg                     { $$.push_back($1); }
+| annotation_args "," annotation_arg { std::swap($$, $1); $$.push_back($3); }
+
+%type<qilang::LiteralNodePtr> annotation_arg;
+annotation_arg:
+  const_exp                        { $$ = $1; }
+| ID                               { $$ = NODE1(StringLiteralNode, @$, $1); }
+
 // #######################################################################################
 // # TYPE
 // #######################################################################################
@@ -212,6 +591,13 @@ type:
 | "Map" "<" type "," type ">"       { $$ = NODE2(MapTypeExprNode, @$, $3, $5); }
 | "Tuple" "<" tuple_type_defs ">"   { $$ = NODE1(TupleTypeExprNode, @$, $3); }
 | "Opt" "<" type ">"                { $$ = NODE1(OptionalTypeExprNode, @$, $3); }
+| "Array" "<" type "," CONSTANT ">" { qilang::IntLiteralNode* size = dynamic_cast<qilang::IntLiteralNode*>($5.get());
+                                      if (!size || size->value == 0) {
+                                        error(@5, "the size of an Array must be a positive integer");
+                                        YYERROR;
+                                      }
+                                      $$ = NODE2(ArrayTypeExprNode, @$, $3, size->value); }
+| "Stream" "<" type ">"             { $$ = NODE1(StreamTypeExprNode, @$, $3); }
 
 
 %type<qilang::TypeExprNodePtrVector> tuple_type_defs;
@@ -236,7 +622,36 @@ typedef:
 
 %type<qilang::DeclNodePtr> enums;
 enums:
-  ENUM ID enums_defs END    { $$ = NODE2(EnumDeclNode, @$, $2, $3); }
+  ENUM ID enums_defs END          { $$ = NODE2(EnumDeclNode, @$, $2, $3); }
+| ENUM ID ":" type enums_defs END { if (!isIntegralType($4)) {
+                                      error(@4, "the underlying type of an enum must be an integer type");
+                                      YYERROR;
+                                    }
+                                    $$ = NODE3(EnumDeclNode, @$, $2, $4, $5); }
+
+// flags are unsigned 32-bit integers by default
+%type<qilang::DeclNodePtr> flags;
+flags:
+  FLAGS ID flags_defs END          { qilang::TypeExprNodePtr type = NODE2(BuiltinTypeExprNode, @$, qilang::BuiltinType_UInt32, "uint32");
+                                     if ($3.size() > flagBits(type)) {
+                                       error(@3, "too many flags for their underlying type");
+                                       YYERROR;
+                                     }
+                                     $$ = makeFlags(@$, $2, type, $3); }
+| FLAGS ID ":" type flags_defs END { if (!isIntegralType($4)) {
+                                       error(@4, "the underlying type of flags must be an integer type");
+                                       YYERROR;
+                                     }
+                                     if ($5.size() > flagBits($4)) {
+                                       error(@5, "too many flags for their underlying type");
+                                       YYERROR;
+                                     }
+                                     $$ = makeFlags(@$, $2, $4, $5); }
+
+%type<qilang::StringVector> flags_defs;
+flags_defs:
+  %empty        {}
+| flags_defs name { std::swap($$, $1); $$.push_back($2); }
 
 %type<qilang::EnumFieldDeclNodePtrVector> enums_defs;
 enums_defs:
@@ -262,8 +677,8 @@ enums_def:
 
 %type<qilang::NodePtr> iface;
 iface:
-  INTERFACE ID "(" inherit_defs ")" interface_defs END { $$ = NODEC3(InterfaceDeclNode, @$, $1, $2, $4, $6); }
-| INTERFACE ID interface_defs END                      { $$ = NODEC2(InterfaceDeclNode, @$, $1, $2, $3); }
+  INTERFACE ID "(" inherit_defs ")" interface_defs END { checkMembers($6); $$ = NODEC3(InterfaceDeclNode, @$, $1, $2, $4, $6); }
+| INTERFACE ID interface_defs END                      { checkMembers($3); $$ = NODEC2(InterfaceDeclNode, @$, $1, $2, $3); }
 
 %type<qilang::StringVector> inherit_defs;
 inherit_defs:
@@ -290,20 +705,21 @@ interface_def:
   function_decl           { std::swap($$, $1); }
 | sig_decl                { std::swap($$, $1); }
 | prop_decl               { std::swap($$, $1); }
+| annotation interface_def { checkMemberAnnotation(@1, $2, $1); $$ = annotate($2, $1); }
 
 // fn foooo (t1, t2, t3) tret
 %type<qilang::DeclNodePtr> function_decl;
 function_decl:
-  FN  ID "(" param_list ")"              { $$ = NODEC2(FnDeclNode, @$, $1, $2, $4); }
-| FN  ID "(" param_list ")" "->" type    { $$ = NODEC3(FnDeclNode, @$, $1, $2, $4, $7); }
+  FN  name "(" param_list ")"            { $$ = NODEC2(FnDeclNode, @$, $1, $2, $4); }
+| FN  name "(" param_list ")" "->" type  { $$ = NODEC3(FnDeclNode, @$, $1, $2, $4, $7); }
 
 %type<qilang::DeclNodePtr> sig_decl;
 sig_decl:
-  SIG ID "(" param_list ")"              { $$ = NODE2(SigDeclNode, @$, $2, $4); }
+  SIG name "(" param_list ")"            { $$ = NODE2(SigDeclNode, @$, $2, $4); }
 
 %type<qilang::DeclNodePtr> prop_decl;
 prop_decl:
-  PROP ID "(" param_list ")"             { $$ = NODE2(PropDeclNode, @$, $2, $4); }
+  PROP name "(" param_list ")"           { $$ = NODE2(PropDeclNode, @$, $2, $4); }
 
 
 %type<qilang::ParamFieldDeclNodePtrVector> param_list;
@@ -325,7 +741,8 @@ param_list.2:
 
 %type<qilang::ParamFieldDeclNodePtr> param;
 param:
-  ID ":" type                 { $$ = NODE2(ParamFieldDeclNode, @$, $1, $3); }
+  name ":" type               { $$ = NODE2(ParamFieldDeclNode, @$, $1, $3); }
+| annotation param            { checkParamAnnotation(@1, $1); $$ = annotate($2, $1); }
 
 %type<qilang::ParamFieldDeclNodePtrVector> param_end;
 param_end:
@@ -335,13 +752,13 @@ param_end:
 
 %type<qilang::ParamFieldDeclNodePtr> param_vargs;
 param_vargs:
-  "*" ID            { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE0(VarArgTypeExprNode, @$), qilang::ParamFieldType_VarArgs); }
-| "*" ID ":" type   { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE1(VarArgTypeExprNode, @$, $4), qilang::ParamFieldType_VarArgs); }
+  "*" name          { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE0(VarArgTypeExprNode, @$), qilang::ParamFieldType_VarArgs); }
+| "*" name ":" type { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE1(VarArgTypeExprNode, @$, $4), qilang::ParamFieldType_VarArgs); }
 
 %type<qilang::ParamFieldDeclNodePtr> param_kwargs;
 param_kwargs:
-  "**" ID           { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE0(KeywordArgTypeExprNode, @$), qilang::ParamFieldType_KeywordArgs); }
-| "**" ID ":" type  { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE1(KeywordArgTypeExprNode, @$, $4), qilang::ParamFieldType_KeywordArgs); }
+  "**" name         { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE0(KeywordArgTypeExprNode, @$), qilang::ParamFieldType_KeywordArgs); }
+| "**" name ":" type { $$ = NODE3(ParamFieldDeclNode, @$, $2, NODE1(KeywordArgTypeExprNode, @$, $4), qilang::ParamFieldType_KeywordArgs); }
 
 
 // #######################################################################################
@@ -351,7 +768,7 @@ param_kwargs:
 %type<qilang::NodePtr> const;
 const:
   CONST ID "=" const_exp    { $$ = NODE2(ConstDeclNode, @$, $2, $4); }
-| CONST ID type "=" const_exp { $$ = NODE3(ConstDeclNode, @$, $2, $3, $5); }
+| CONST ID type "=" const_exp { checkConst(@5, $3, $5); $$ = NODE3(ConstDeclNode, @$, $2, $3, $5); }
 
 
 // #######################################################################################
@@ -361,6 +778,7 @@ const:
 struct:
   STRUCT ID struct_field_defs END                      { $$ = NODE2(StructDeclNode, @$, $2, $3); }
 | STRUCT ID "(" inherit_defs ")" struct_field_defs END { $$ = NODE3(StructDeclNode, @$, $2, $4, $6); }
+| annotation struct                                    { checkStructAnnotation(@1, $1); $$ = annotate(boost::static_pointer_cast<qilang::DeclNode>($2), $1); }
 
 %type<qilang::DeclNodePtrVector> struct_field_defs;
 struct_field_defs:
@@ -374,9 +792,9 @@ struct_field_defs.1:
 
 %type<qilang::DeclNodePtrVector> struct_field_def;
 struct_field_def:
-  ID ":" type              { $$.push_back(NODE2(StructFieldDeclNode, @$, $1, $3)); }
-| ID ":" type "=" const_exp { $$.push_back(NODE3(StructFieldDeclNode, @$, $1, $3, $5)); }
-| ID "," id_list ":" type  { $$.push_back(NODE2(StructFieldDeclNode, @$, $1, $5));
+  name ":" type              { $$.push_back(NODE2(StructFieldDeclNode, @$, $1, $3)); }
+| name ":" type "=" const_exp { checkConst(@5, $3, $5); $$.push_back(NODE3(StructFieldDeclNode, @$, $1, $3, $5)); }
+| name "," id_list ":" type  { $$.push_back(NODE2(StructFieldDeclNode, @$, $1, $5));
                          for (unsigned i = 0; i < $3.size(); ++i) {
                             $$.push_back(NODE2(StructFieldDeclNode, @$, $3.at(i), $5));
                          }
@@ -397,10 +815,22 @@ const_data:
 | list     { $$ = $1; }
 | tuple    { $$ = $1; }
 
-//later it will be more
+// constant expressions are folded as they are parsed
 %type<qilang::LiteralNodePtr> const_exp;
 const_exp:
-  const_data { std::swap($$, $1); }
+  const_data                  { std::swap($$, $1); }
+| "(" const_exp ")"           { std::swap($$, $2); }
+| "-" const_exp %prec UNARY   { $$ = foldUnary(@$, qilang::UnaryOpCode_Minus, $2); }
+| "!" const_exp %prec UNARY   { $$ = foldUnary(@$, qilang::UnaryOpCode_Negate, $2); }
+| "~" const_exp %prec UNARY   { $$ = foldUnary(@$, qilang::UnaryOpCode_Complement, $2); }
+| const_exp "+" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_Plus, $1, $3); }
+| const_exp "-" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_Minus, $1, $3); }
+| const_exp "*" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_Multiply, $1, $3); }
+| const_exp "/" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_Divide, $1, $3); }
+| const_exp "%" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_Modulus, $1, $3); }
+| const_exp "|" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_Or, $1, $3); }
+| const_exp "&" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_And, $1, $3); }
+| const_exp "^" const_exp     { $$ = foldBinary(@$, qilang::BinaryOpCode_Xor, $1, $3); }
 
 
 // #######################################################################################
@@ -27,11 +27,14 @@ namespace qilang {
   const std::string &UnaryOpCodeToString(UnaryOpCode op) {
     static std::string minus("-");
     static std::string negate("!");
+    static std::string complement("~");
     switch(op) {
     case UnaryOpCode_Minus:
       return minus;
     case UnaryOpCode_Negate:
       return negate;
+    case UnaryOpCode_Complement:
+      return complement;
     }
     throw std::runtime_error("invalid unary op code");
   }
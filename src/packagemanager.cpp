@@ -87,6 +87,17 @@ namespace qilang {
     return it->second;
   }
 
+  NodePtrVector PackageManager::ast(const std::string& filename) {
+    FilenameToPackageMap::const_iterator it = _sources.find(filename);
+    if (it == _sources.end())
+      throw std::runtime_error("file not parsed '" + filename + "'");
+    PackagePtr pkg = package(it->second);
+    ParseResultMap::const_iterator content = pkg->_contents.find(filename);
+    if (content == pkg->_contents.end())
+      throw std::runtime_error("file not parsed '" + filename + "'");
+    return content->second->ast;
+  }
+
   /** 1 / Check for missing or multiple package declaration
    *  2 / Check that the directory path and package name match
    *  3 / register the content of the file to the package
@@ -429,6 +440,10 @@ namespace qilang {
         tnode->resolved_package = sp.pkg;
         tnode->resolved_value   = sp.type;
         tnode->resolved_kind    = sp.kind;
+        if (sp.kind == TypeKind_Enum) {
+          NodePtr decl = package(sp.pkg)->getExport(sp.type);
+          tnode->resolved_underlying_type = static_cast<EnumDeclNode*>(decl.get())->underlyingType;
+        }
       }
     }
   }
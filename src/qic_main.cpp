@@ -25,7 +25,8 @@ int codegen_service(const std::string& codegen,
                     qilang::FileWriterPtr out,
                     qilang::PackageManagerPtr pm,
                     qi::SessionPtr session,
-                    const std::string& service) {
+                    const std::string& service,
+                    const qilang::CodegenOptions& options) {
   qiLogVerbose() << "Generation " << codegen << " for service " << service;
 
   qi::AnyObject obj = session->service(service).value();
@@ -37,7 +38,7 @@ int codegen_service(const std::string& codegen,
   qilang::ParseResultPtr pr = qilang::newParseResult();
   pr->ast = objs;
 
-  bool succ = qilang::codegen(out, codegen, pm, pr);
+  bool succ = qilang::codegen(out, codegen, pm, pr, options);
   if (!succ)
     return 1;
   return 0;
@@ -46,7 +47,8 @@ int codegen_service(const std::string& codegen,
 int codegen_file(const std::string& codegen,
                  qilang::FileWriterPtr out,
                  qilang::PackageManagerPtr pm,
-                 const std::string& file) {
+                 const std::string& file,
+                 const qilang::CodegenOptions& options) {
   qiLogVerbose() << "Generating " << codegen << " for file " << file;
   qilang::ParseResultPtr pr;
   try {
@@ -55,7 +57,7 @@ int codegen_file(const std::string& codegen,
     std::cerr << "Exception: " << e.what() << std::endl;
     exit(1);
   }
-  bool ret = qilang::codegen(out, codegen, pm, pr);
+  bool ret = qilang::codegen(out, codegen, pm, pr, options);
   if (!ret)
     return 1;
   return 0;
@@ -73,6 +75,7 @@ int main(int argc, char *argv[])
   boost::optional<std::string> outputFile;
   boost::optional<std::string> targetSdkDir;
   std::vector<std::string> importDirs;
+  qilang::CodegenOptions options;
   po::options_description desc("qilang options");
   desc.add_options()
       ("help,h", po::bool_switch(&help), "produce help message")
@@ -82,6 +85,16 @@ int main(int argc, char *argv[])
       ("output-file,o", po::value(&outputFile), "output file")
       ("target-sdk-dir,t", po::value(&targetSdkDir), "the SDK directory of the target platform")
       (",I", po::value(&importDirs)->composing(), "add a directory to be searched for imported packages")
+      ("specialized-structs", po::bool_switch(&options.specializedStructs),
+       "register structs with a generated type interface instead of QI_TYPE_STRUCT")
+      ("reorder-struct-fields", po::bool_switch(&options.reorderStructFields),
+       "store struct members by decreasing alignment to minimize padding")
+      ("instrument", po::bool_switch(&options.instrument),
+       "count the calls, errors and latencies of the methods of local bindings and remote proxies")
+      ("trace", po::bool_switch(&options.trace),
+       "record a span of each call of the methods of local bindings and remote proxies")
+      ("probes", po::bool_switch(&options.probes),
+       "fire USDT probes at the entry and the exit of the methods of local bindings and remote proxies")
       ;
 
   po::positional_options_description p;
@@ -124,9 +137,9 @@ int main(int argc, char *argv[])
 
     if (mode == "service") {
       app.startSession();
-      return codegen_service(codegen, out, pm, app.session(), idlFile);
+      return codegen_service(codegen, out, pm, app.session(), idlFile, options);
     } else if (mode == "file") {
-      return codegen_file(codegen, out, pm, idlFile);
+      return codegen_file(codegen, out, pm, idlFile, options);
     } else {
       throw std::runtime_error("bad input option value. must be service or file");
     }
@@ -0,0 +1,489 @@
+/*
+** Author(s):
+**  - Cedric GESTES <gestes@aldebaran-robotics.com>
+**
+** Copyright (C) 2014 Aldebaran Robotics
+*/
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <qilang/parser.hpp>
+#include <qilang/formatter.hpp>
+
+namespace qilang {
+
+namespace {
+
+  const char* literalKindName(const LiteralNode* node) {
+    switch (node->type()) {
+      case NodeType_BoolData:   return "bool";
+      case NodeType_IntData:    return "int";
+      case NodeType_FloatData:  return "float";
+      case NodeType_StringData: return "str";
+      case NodeType_ListData:   return "list";
+      case NodeType_TupleData:  return "tuple";
+      case NodeType_MapData:    return "dict";
+      default:                  return "unknown";
+    }
+  }
+
+  bool isNumber(const LiteralNode* node) {
+    return node->type() == NodeType_IntData || node->type() == NodeType_FloatData;
+  }
+
+  // ints range from the min of qi::int64_t to the max of qi::uint64_t: they are stored with their
+  // sign, negative ones in two's complement
+  bool isNegative(const LiteralNode* node) {
+    return static_cast<const IntLiteralNode*>(node)->negative();
+  }
+
+  qi::uint64_t intBits(const LiteralNode* node) {
+    return static_cast<const IntLiteralNode*>(node)->value;
+  }
+
+  // the absolute value of an int
+  qi::uint64_t magnitude(const LiteralNode* node) {
+    return isNegative(node) ? 0 - intBits(node) : intBits(node);
+  }
+
+  // whether an int is above the max of qi::int64_t
+  bool isUnsigned(const LiteralNode* node) {
+    return !isNegative(node) && intBits(node) > static_cast<qi::uint64_t>(std::numeric_limits<qi::int64_t>::max());
+  }
+
+  double floatValue(const LiteralNode* node) {
+    if (node->type() == NodeType_IntData)
+      return isNegative(node) ? static_cast<double>(static_cast<qi::int64_t>(intBits(node)))
+                              : static_cast<double>(intBits(node));
+    return static_cast<const FloatLiteralNode*>(node)->value;
+  }
+
+  bool boolValue(const LiteralNode* node) {
+    return static_cast<const BoolLiteralNode*>(node)->value;
+  }
+
+  const std::string& stringValue(const LiteralNode* node) {
+    return static_cast<const StringLiteralNode*>(node)->value;
+  }
+
+  std::runtime_error badOperands(BinaryOpCode op, const LiteralNode* left, const LiteralNode* right) {
+    return std::runtime_error(std::string("operator ") + BinaryOpCodeToString(op) + " cannot be applied to "
+                              + literalKindName(left) + " and " + literalKindName(right));
+  }
+
+  std::runtime_error overflow() {
+    return std::runtime_error("overflow in a constant expression");
+  }
+
+  LiteralNodePtr makeInt(bool negative, qi::uint64_t magnitude, const Location& loc) {
+    if (magnitude == 0)
+      negative = false;
+    if (negative && magnitude - 1 > static_cast<qi::uint64_t>(std::numeric_limits<qi::int64_t>::max()))
+      throw overflow();
+    return boost::make_shared<IntLiteralNode>(negative ? 0 - magnitude : magnitude, loc, negative);
+  }
+
+  // bitwise operations work on the 64 bits of two's complement, as for qi::int64_t unless one of
+  // the operands only fits in a qi::uint64_t
+  LiteralNodePtr makeBits(qi::uint64_t bits, bool isUnsigned, const Location& loc) {
+    return boost::make_shared<IntLiteralNode>(bits, loc, !isUnsigned && static_cast<qi::int64_t>(bits) < 0);
+  }
+
+  LiteralNodePtr addInts(bool lneg, qi::uint64_t l, bool rneg, qi::uint64_t r, const Location& loc) {
+    if (lneg == rneg) {
+      if (l > std::numeric_limits<qi::uint64_t>::max() - r)
+        throw overflow();
+      return makeInt(lneg, l + r, loc);
+    }
+    if (l >= r)
+      return makeInt(lneg, l - r, loc);
+    return makeInt(rneg, r - l, loc);
+  }
+
+  // results that are not finite, which C++ has no literals for, are errors
+  LiteralNodePtr makeFloat(double value, const Location& loc) {
+    if (!std::isfinite(value))
+      throw overflow();
+    return boost::make_shared<FloatLiteralNode>(value, loc);
+  }
+
+  LiteralNodePtr makeBool(bool value, const Location& loc) {
+    return boost::make_shared<BoolLiteralNode>(value, loc);
+  }
+
+  LiteralNodePtr evalUnary(const UnaryOpExprNode* node) {
+    const LiteralNodePtr operand = evalConstExpr(node->expr);
+    const Location& loc = node->loc();
+    switch (node->op) {
+      case UnaryOpCode_Minus:
+        if (operand->type() == NodeType_IntData)
+          return makeInt(!isNegative(operand.get()), magnitude(operand.get()), loc);
+        if (operand->type() == NodeType_FloatData)
+          return boost::make_shared<FloatLiteralNode>(-floatValue(operand.get()), loc);
+        break;
+      case UnaryOpCode_Negate:
+        if (operand->type() == NodeType_BoolData)
+          return makeBool(!boolValue(operand.get()), loc);
+        break;
+      case UnaryOpCode_Complement:
+        if (operand->type() == NodeType_IntData)
+          return makeBits(~intBits(operand.get()), isUnsigned(operand.get()), loc);
+        break;
+    }
+    throw std::runtime_error(std::string("operator ") + UnaryOpCodeToString(node->op) + " cannot be applied to "
+                             + literalKindName(operand.get()));
+  }
+
+  LiteralNodePtr evalArithmetic(BinaryOpCode op, const LiteralNode* left, const LiteralNode* right, const Location& loc) {
+    if (left->type() == NodeType_IntData && right->type() == NodeType_IntData) {
+      // computed on the signs and magnitudes: results out of the range of ints are errors
+      const bool lneg = isNegative(left);
+      const bool rneg = isNegative(right);
+      const qi::uint64_t l = magnitude(left);
+      const qi::uint64_t r = magnitude(right);
+      switch (op) {
+        case BinaryOpCode_Plus:
+          return addInts(lneg, l, rneg, r, loc);
+        case BinaryOpCode_Minus:
+          return addInts(lneg, l, !rneg, r, loc);
+        case BinaryOpCode_Multiply:
+          if (l != 0 && r > std::numeric_limits<qi::uint64_t>::max() / l)
+            throw overflow();
+          return makeInt(lneg != rneg, l * r, loc);
+        default:
+          break;
+      }
+      if (r == 0)
+        throw std::runtime_error("division by zero in a constant expression");
+      // both truncate toward zero, the remainder has the sign of the dividend
+      if (op == BinaryOpCode_Divide)
+        return makeInt(lneg != rneg, l / r, loc);
+      return makeInt(lneg, l % r, loc);
+    }
+
+    const double l = floatValue(left);
+    const double r = floatValue(right);
+    switch (op) {
+      case BinaryOpCode_Plus:     return makeFloat(l + r, loc);
+      case BinaryOpCode_Minus:    return makeFloat(l - r, loc);
+      case BinaryOpCode_Multiply: return makeFloat(l * r, loc);
+      case BinaryOpCode_Divide:
+        if (r == 0.0)
+          throw std::runtime_error("division by zero in a constant expression");
+        return makeFloat(l / r, loc);
+      default:
+        throw badOperands(op, left, right);
+    }
+  }
+
+  LiteralNodePtr evalComparison(BinaryOpCode op, const LiteralNode* left, const LiteralNode* right, const Location& loc) {
+    int order;
+    if (isNumber(left) && isNumber(right)) {
+      if (left->type() == NodeType_IntData && right->type() == NodeType_IntData) {
+        if (isNegative(left) != isNegative(right))
+          order = isNegative(left) ? -1 : 1;
+        else // two's complement keeps the order of values of a same sign
+          order = (intBits(left) > intBits(right)) - (intBits(left) < intBits(right));
+      }
+      else
+        order = (floatValue(left) > floatValue(right)) - (floatValue(left) < floatValue(right));
+    } else if (left->type() == NodeType_StringData && right->type() == NodeType_StringData) {
+      order = stringValue(left).compare(stringValue(right));
+    } else if (left->type() == NodeType_BoolData && right->type() == NodeType_BoolData
+               && (op == BinaryOpCode_EqEq || op == BinaryOpCode_Ne)) {
+      order = boolValue(left) == boolValue(right) ? 0 : 1;
+    } else {
+      throw badOperands(op, left, right);
+    }
+
+    switch (op) {
+      case BinaryOpCode_EqEq: return makeBool(order == 0, loc);
+      case BinaryOpCode_Ne:   return makeBool(order != 0, loc);
+      case BinaryOpCode_Gt:   return makeBool(order > 0, loc);
+      case BinaryOpCode_Lt:   return makeBool(order < 0, loc);
+      case BinaryOpCode_Ge:   return makeBool(order >= 0, loc);
+      default:                return makeBool(order <= 0, loc);
+    }
+  }
+
+  LiteralNodePtr evalBinary(const BinaryOpExprNode* node) {
+    const LiteralNodePtr left = evalConstExpr(node->left);
+    const LiteralNodePtr right = evalConstExpr(node->right);
+    const Location& loc = node->loc();
+    const LiteralNode* l = left.get();
+    const LiteralNode* r = right.get();
+
+    switch (node->op) {
+      case BinaryOpCode_Plus:
+        if (l->type() == NodeType_StringData && r->type() == NodeType_StringData)
+          return boost::make_shared<StringLiteralNode>(stringValue(l) + stringValue(r), loc);
+        // fall through
+      case BinaryOpCode_Minus:
+      case BinaryOpCode_Multiply:
+      case BinaryOpCode_Divide:
+        if (!isNumber(l) || !isNumber(r))
+          throw badOperands(node->op, l, r);
+        return evalArithmetic(node->op, l, r, loc);
+      case BinaryOpCode_Modulus:
+        if (l->type() != NodeType_IntData || r->type() != NodeType_IntData)
+          throw badOperands(node->op, l, r);
+        return evalArithmetic(node->op, l, r, loc);
+
+      case BinaryOpCode_And:
+      case BinaryOpCode_Or:
+      case BinaryOpCode_Xor:
+        if (l->type() == NodeType_IntData && r->type() == NodeType_IntData) {
+          const bool isUnsignedOp = isUnsigned(l) || isUnsigned(r);
+          if (node->op == BinaryOpCode_And)
+            return makeBits(intBits(l) & intBits(r), isUnsignedOp, loc);
+          if (node->op == BinaryOpCode_Or)
+            return makeBits(intBits(l) | intBits(r), isUnsignedOp, loc);
+          return makeBits(intBits(l) ^ intBits(r), isUnsignedOp, loc);
+        }
+        // fall through
+      case BinaryOpCode_BoolAnd:
+      case BinaryOpCode_BoolOr:
+        if (l->type() != NodeType_BoolData || r->type() != NodeType_BoolData)
+          throw badOperands(node->op, l, r);
+        if (node->op == BinaryOpCode_And || node->op == BinaryOpCode_BoolAnd)
+          return makeBool(boolValue(l) && boolValue(r), loc);
+        if (node->op == BinaryOpCode_Or || node->op == BinaryOpCode_BoolOr)
+          return makeBool(boolValue(l) || boolValue(r), loc);
+        return makeBool(boolValue(l) != boolValue(r), loc);
+
+      case BinaryOpCode_EqEq:
+      case BinaryOpCode_Ne:
+      case BinaryOpCode_Gt:
+      case BinaryOpCode_Lt:
+      case BinaryOpCode_Ge:
+      case BinaryOpCode_Le:
+        return evalComparison(node->op, l, r, loc);
+
+      case BinaryOpCode_FetchArray: {
+        const LiteralNodePtrVector* values = 0;
+        if (l->type() == NodeType_ListData)
+          values = &static_cast<const ListLiteralNode*>(l)->values;
+        else if (l->type() == NodeType_TupleData)
+          values = &static_cast<const TupleLiteralNode*>(l)->values;
+        if (!values || r->type() != NodeType_IntData)
+          throw badOperands(node->op, l, r);
+        if (isNegative(r) || intBits(r) >= values->size())
+          throw std::runtime_error("index out of range in a constant expression");
+        return values->at(static_cast<std::size_t>(intBits(r)));
+      }
+    }
+    throw badOperands(node->op, l, r);
+  }
+
+  bool fitsIn(const IntLiteralNode* node, qi::int64_t min, qi::uint64_t max) {
+    if (node->negative())
+      return static_cast<qi::int64_t>(node->value) >= min;
+    return node->value <= max;
+  }
+
+  bool isIntegral(BuiltinType type) {
+    return type >= BuiltinType_Char && type <= BuiltinType_UInt64;
+  }
+
+  // range of the integral builtin types
+  void integralRange(BuiltinType type, qi::int64_t& min, qi::uint64_t& max) {
+    switch (type) {
+      case BuiltinType_Char:
+      case BuiltinType_Int8:   min = std::numeric_limits<qi::int8_t>::min();  max = std::numeric_limits<qi::int8_t>::max();   return;
+      case BuiltinType_UInt8:  min = 0;                                       max = std::numeric_limits<qi::uint8_t>::max();  return;
+      case BuiltinType_Int16:  min = std::numeric_limits<qi::int16_t>::min(); max = std::numeric_limits<qi::int16_t>::max();  return;
+      case BuiltinType_UInt16: min = 0;                                       max = std::numeric_limits<qi::uint16_t>::max(); return;
+      case BuiltinType_Int:
+      case BuiltinType_Int32:  min = std::numeric_limits<qi::int32_t>::min(); max = std::numeric_limits<qi::int32_t>::max();  return;
+      case BuiltinType_UInt:
+      case BuiltinType_UInt32: min = 0;                                       max = std::numeric_limits<qi::uint32_t>::max(); return;
+      case BuiltinType_Int64:  min = std::numeric_limits<qi::int64_t>::min(); max = std::numeric_limits<qi::int64_t>::max();  return;
+      default:                 min = 0;                                       max = std::numeric_limits<qi::uint64_t>::max(); return;
+    }
+  }
+
+  std::string mismatch(const TypeExprNodePtr& type, const LiteralNode* value) {
+    return std::string("a ") + literalKindName(value) + " cannot be stored in a constant of type " + format(type);
+  }
+
+  std::string checkElements(const TypeExprNodePtr& element, const LiteralNodePtrVector& values) {
+    for (unsigned i = 0; i < values.size(); ++i) {
+      const std::string error = checkConstType(element, values.at(i));
+      if (!error.empty())
+        return error;
+    }
+    return std::string();
+  }
+
+  TypeExprNodePtr builtinType(BuiltinType type, const char* name, const Location& loc) {
+    return boost::make_shared<BuiltinTypeExprNode>(type, name, loc);
+  }
+
+  // the type of both `a` and `b`, ints being widened, or null if they differ
+  TypeExprNodePtr commonType(const TypeExprNodePtr& a, const TypeExprNodePtr& b) {
+    if (!a || !b)
+      return TypeExprNodePtr();
+    const std::string fa = format(a);
+    const std::string fb = format(b);
+    if (fa == fb)
+      return a;
+    if ((fa == "int" || fa == "int64") && (fb == "int" || fb == "int64"))
+      return fa == "int64" ? a : b;
+    return TypeExprNodePtr();
+  }
+
+  TypeExprNodePtr elementsType(const LiteralNodePtrVector& values) {
+    if (values.empty())
+      return TypeExprNodePtr();
+    TypeExprNodePtr type = inferConstType(values.at(0));
+    for (unsigned i = 1; i < values.size(); ++i)
+      type = commonType(type, inferConstType(values.at(i)));
+    return type;
+  }
+}
+
+LiteralNodePtr evalConstExpr(const ExprNodePtr& expr) {
+  switch (expr->type()) {
+    case NodeType_LiteralExpr:
+      return static_cast<LiteralExprNode*>(expr.get())->data;
+    case NodeType_BinOpExpr:
+      return evalBinary(static_cast<BinaryOpExprNode*>(expr.get()));
+    case NodeType_UOpExpr:
+      // calls have the node type of unary operations
+      if (const UnaryOpExprNode* node = dynamic_cast<UnaryOpExprNode*>(expr.get()))
+        return evalUnary(node);
+      break;
+    default:
+      break;
+  }
+  throw std::runtime_error("not a constant expression");
+}
+
+std::string checkConstType(const TypeExprNodePtr& type, const LiteralNodePtr& value) {
+  const LiteralNode* v = value.get();
+  switch (type->type()) {
+    case NodeType_BuiltinTypeExpr: {
+      const BuiltinType builtin = static_cast<BuiltinTypeExprNode*>(type.get())->builtinType;
+      if (builtin == BuiltinType_Value)
+        return std::string();
+      if (builtin == BuiltinType_Bool)
+        return v->type() == NodeType_BoolData ? std::string() : mismatch(type, v);
+      if (builtin == BuiltinType_String)
+        return v->type() == NodeType_StringData ? std::string() : mismatch(type, v);
+      if (builtin == BuiltinType_Float || builtin == BuiltinType_Float32 || builtin == BuiltinType_Float64)
+        return isNumber(v) ? std::string() : mismatch(type, v);
+      if (isIntegral(builtin)) {
+        if (v->type() != NodeType_IntData)
+          return mismatch(type, v);
+        qi::int64_t min;
+        qi::uint64_t max;
+        integralRange(builtin, min, max);
+        if (!fitsIn(static_cast<const IntLiteralNode*>(v), min, max))
+          return "value out of the range of " + format(type);
+        return std::string();
+      }
+      return mismatch(type, v);
+    }
+    case NodeType_ListTypeExpr:
+      if (v->type() != NodeType_ListData)
+        return mismatch(type, v);
+      return checkElements(static_cast<ListTypeExprNode*>(type.get())->element,
+                           static_cast<const ListLiteralNode*>(v)->values);
+    case NodeType_ArrayTypeExpr: {
+      ArrayTypeExprNode* tnode = static_cast<ArrayTypeExprNode*>(type.get());
+      if (v->type() != NodeType_ListData)
+        return mismatch(type, v);
+      const LiteralNodePtrVector& values = static_cast<const ListLiteralNode*>(v)->values;
+      if (values.size() > tnode->size)
+        return "too many values for " + format(type);
+      return checkElements(tnode->element, values);
+    }
+    case NodeType_TupleTypeExpr: {
+      TupleTypeExprNode* tnode = static_cast<TupleTypeExprNode*>(type.get());
+      if (v->type() != NodeType_TupleData)
+        return mismatch(type, v);
+      const LiteralNodePtrVector& values = static_cast<const TupleLiteralNode*>(v)->values;
+      if (values.size() != tnode->elements.size())
+        return "wrong number of values for " + format(type);
+      for (unsigned i = 0; i < values.size(); ++i) {
+        const std::string error = checkConstType(tnode->elements.at(i), values.at(i));
+        if (!error.empty())
+          return error;
+      }
+      return std::string();
+    }
+    case NodeType_MapTypeExpr: {
+      MapTypeExprNode* tnode = static_cast<MapTypeExprNode*>(type.get());
+      if (v->type() != NodeType_MapData)
+        return mismatch(type, v);
+      const LiteralNodePtrPairVector& values = static_cast<const DictLiteralNode*>(v)->values;
+      for (unsigned i = 0; i < values.size(); ++i) {
+        std::string error = checkConstType(tnode->key, values.at(i).first);
+        if (error.empty())
+          error = checkConstType(tnode->value, values.at(i).second);
+        if (!error.empty())
+          return error;
+      }
+      return std::string();
+    }
+    case NodeType_OptionalTypeExpr:
+      return checkConstType(static_cast<OptionalTypeExprNode*>(type.get())->element, value);
+    default:
+      // custom types are only known after the resolution of the package
+      return std::string();
+  }
+}
+
+TypeExprNodePtr inferConstType(const LiteralNodePtr& value) {
+  const Location& loc = value->loc();
+  switch (value->type()) {
+    case NodeType_BoolData:
+      return builtinType(BuiltinType_Bool, "bool", loc);
+    case NodeType_IntData: {
+      const IntLiteralNode* node = static_cast<const IntLiteralNode*>(value.get());
+      if (fitsIn(node, std::numeric_limits<qi::int32_t>::min(), std::numeric_limits<qi::int32_t>::max()))
+        return builtinType(BuiltinType_Int, "int", loc);
+      if (fitsIn(node, std::numeric_limits<qi::int64_t>::min(), std::numeric_limits<qi::int64_t>::max()))
+        return builtinType(BuiltinType_Int64, "int64", loc);
+      return builtinType(BuiltinType_UInt64, "uint64", loc);
+    }
+    case NodeType_FloatData:
+      return builtinType(BuiltinType_Float64, "float64", loc);
+    case NodeType_StringData:
+      return builtinType(BuiltinType_String, "str", loc);
+    case NodeType_ListData: {
+      TypeExprNodePtr element = elementsType(static_cast<const ListLiteralNode*>(value.get())->values);
+      if (!element)
+        return TypeExprNodePtr();
+      return boost::make_shared<ListTypeExprNode>(element, loc);
+    }
+    case NodeType_TupleData: {
+      const LiteralNodePtrVector& values = static_cast<const TupleLiteralNode*>(value.get())->values;
+      TypeExprNodePtrVector elements;
+      for (unsigned i = 0; i < values.size(); ++i) {
+        elements.push_back(inferConstType(values.at(i)));
+        if (!elements.back())
+          return TypeExprNodePtr();
+      }
+      return boost::make_shared<TupleTypeExprNode>(elements, loc);
+    }
+    case NodeType_MapData: {
+      const LiteralNodePtrPairVector& values = static_cast<const DictLiteralNode*>(value.get())->values;
+      LiteralNodePtrVector keys, mapped;
+      for (unsigned i = 0; i < values.size(); ++i) {
+        keys.push_back(values.at(i).first);
+        mapped.push_back(values.at(i).second);
+      }
+      TypeExprNodePtr key = elementsType(keys);
+      TypeExprNodePtr element = elementsType(mapped);
+      if (!key || !element)
+        return TypeExprNodePtr();
+      return boost::make_shared<MapTypeExprNode>(key, element, loc);
+    }
+    default:
+      return TypeExprNodePtr();
+  }
+}
+
+}
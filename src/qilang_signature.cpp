@@ -158,6 +158,147 @@ TypeExprNodePtr signatureToQiLang(const qi::Signature& sig) {
   return qlsc.visit(sig);
 }
 
+static bool builtinTypeToSignature(BuiltinType type, std::string& signature) {
+  switch (type) {
+    case BuiltinType_Nothing:
+      signature += 'v';
+      return true;
+    case BuiltinType_Bool:
+      signature += 'b';
+      return true;
+    case BuiltinType_Char:
+    case BuiltinType_Int8:
+      signature += 'c';
+      return true;
+    case BuiltinType_UInt8:
+      signature += 'C';
+      return true;
+    case BuiltinType_Int16:
+      signature += 'w';
+      return true;
+    case BuiltinType_UInt16:
+      signature += 'W';
+      return true;
+    case BuiltinType_Int:
+    case BuiltinType_Int32:
+      signature += 'i';
+      return true;
+    case BuiltinType_UInt:
+    case BuiltinType_UInt32:
+      signature += 'I';
+      return true;
+    case BuiltinType_Int64:
+      signature += 'l';
+      return true;
+    case BuiltinType_UInt64:
+      signature += 'L';
+      return true;
+    case BuiltinType_Float:
+    case BuiltinType_Float32:
+      signature += 'f';
+      return true;
+    case BuiltinType_Float64:
+      signature += 'd';
+      return true;
+    case BuiltinType_String:
+      signature += 's';
+      return true;
+    case BuiltinType_Raw:
+    case BuiltinType_RawView:
+      signature += 'r';
+      return true;
+    case BuiltinType_Value:
+      signature += 'm';
+      return true;
+    case BuiltinType_Object:
+      signature += 'o';
+      return true;
+    // durations and time points signatures are defined by their libqi registration
+    case BuiltinType_NanoSeconds:
+    case BuiltinType_MicroSeconds:
+    case BuiltinType_MilliSeconds:
+    case BuiltinType_Seconds:
+    case BuiltinType_Minutes:
+    case BuiltinType_Hours:
+    case BuiltinType_QiTimePoint:
+    case BuiltinType_SteadyTimePoint:
+    case BuiltinType_SystemTimePoint:
+      return false;
+  }
+  return false;
+}
+
+bool qiLangToSignature(const TypeExprNodePtr& type, std::string& signature) {
+  switch (type->type()) {
+    case NodeType_BuiltinTypeExpr:
+      return builtinTypeToSignature(static_cast<BuiltinTypeExprNode*>(type.get())->builtinType, signature);
+    case NodeType_CustomTypeExpr: {
+      CustomTypeExprNode* tnode = static_cast<CustomTypeExprNode*>(type.get());
+      if (tnode->resolved_kind == TypeKind_Interface) {
+        signature += 'o';
+        return true;
+      }
+      if (tnode->resolved_kind == TypeKind_Enum) {
+        if (tnode->resolved_underlying_type)
+          return qiLangToSignature(tnode->resolved_underlying_type, signature);
+        signature += 'i';
+        return true;
+      }
+      // struct signatures carry names and annotations, let libqi compute them
+      return false;
+    }
+    case NodeType_ListTypeExpr: {
+      signature += '[';
+      if (!qiLangToSignature(static_cast<ListTypeExprNode*>(type.get())->element, signature))
+        return false;
+      signature += ']';
+      return true;
+    }
+    case NodeType_MapTypeExpr: {
+      MapTypeExprNode* tnode = static_cast<MapTypeExprNode*>(type.get());
+      signature += '{';
+      if (!qiLangToSignature(tnode->key, signature) || !qiLangToSignature(tnode->value, signature))
+        return false;
+      signature += '}';
+      return true;
+    }
+    case NodeType_TupleTypeExpr: {
+      // only pairs are supported by the C++ generators
+      TupleTypeExprNode* tnode = static_cast<TupleTypeExprNode*>(type.get());
+      if (tnode->elements.size() != 2)
+        return false;
+      signature += '(';
+      for (unsigned i = 0; i < tnode->elements.size(); ++i) {
+        if (!qiLangToSignature(tnode->elements.at(i), signature))
+          return false;
+      }
+      signature += ')';
+      return true;
+    }
+    case NodeType_ArrayTypeExpr: {
+      // registered as a tuple of `size` elements
+      ArrayTypeExprNode* tnode = static_cast<ArrayTypeExprNode*>(type.get());
+      signature += '(';
+      for (qi::uint64_t i = 0; i < tnode->size; ++i) {
+        if (!qiLangToSignature(tnode->element, signature))
+          return false;
+      }
+      signature += ')';
+      return true;
+    }
+    case NodeType_StreamTypeExpr:
+      // the stream is an object read by chunks
+      signature += 'o';
+      return true;
+    case NodeType_OptionalTypeExpr: {
+      signature += '+';
+      return qiLangToSignature(static_cast<OptionalTypeExprNode*>(type.get())->element, signature);
+    }
+    default:
+      return false;
+  }
+}
+
 
 
 }
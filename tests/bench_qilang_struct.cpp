@@ -0,0 +1,84 @@
+/*
+** Serialization throughput of IDL structs registered with `QI_TYPE_STRUCT` vs the
+** specialized struct types generated by `qicc --specialized-structs`, with their
+** members in declaration order and reordered by `--reorder-struct-fields`.
+**
+** Usage: bench_qilang_struct [iterations]
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <qi/binarycodec.hpp>
+#include <qi/type/typeinterface.hpp>
+#include <benchqilang/telemetry.hpp>
+#include <testqilang/telemetry.hpp>
+
+// Same layout as the generated structs, registered through libqi's reflection.
+struct MacroPosition
+{
+  double x, y, z;
+};
+QI_TYPE_STRUCT(MacroPosition, x, y, z)
+
+struct MacroTelemetry
+{
+  qi::int64_t timestamp;
+  MacroPosition position;
+  float battery;
+  int status;
+  std::string label;
+  std::vector<float> samples;
+};
+QI_TYPE_STRUCT(MacroTelemetry, timestamp, position, battery, status, label, samples)
+
+template <typename Telemetry, typename Position>
+static Telemetry makeTelemetry()
+{
+  Telemetry telemetry;
+  telemetry.timestamp = 1234567890123;
+  telemetry.position = Position{ 1.5, -2.5, 3.25 };
+  telemetry.battery = 0.75f;
+  telemetry.status = 3;
+  telemetry.label = "left arm";
+  telemetry.samples.assign(16, 0.5f);
+  return telemetry;
+}
+
+// Encodes then decodes `value` `iterations` times, and prints the throughput.
+template <typename T>
+static void bench(const std::string& name, const T& value, int iterations)
+{
+  using Clock = std::chrono::steady_clock;
+  std::size_t bytes = 0;
+  T decoded;
+
+  const auto start = Clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    qi::Buffer buffer;
+    qi::encodeBinary(&buffer, qi::AutoAnyReference(value));
+    qi::BufferReader reader(buffer);
+    qi::decodeBinary(&reader, &decoded);
+    bytes += buffer.totalSize();
+  }
+  const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+  std::cout << name << ": "
+            << iterations / elapsed.count() << " round trips/s, "
+            << bytes / elapsed.count() / (1024 * 1024) << " MiB/s" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+  const int iterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+  bench("QI_TYPE_STRUCT       ", makeTelemetry<MacroTelemetry, MacroPosition>(), iterations);
+  bench("specialized structs  ",
+        makeTelemetry<benchqilang::Telemetry, benchqilang::Position>(), iterations);
+  bench("+ reordered members  ",
+        makeTelemetry<testqilang::Telemetry, testqilang::Position>(), iterations);
+  return EXIT_SUCCESS;
+}
@@ -9,6 +9,8 @@ struct BuffyImpl
 {
   Vampire fightAgainst(const Vampire& v) { return v; }
   qi::Buffer bufferIdentity(const qi::Buffer& b) { return b; }
+  qilang::SharedBuffer viewIdentity(const qilang::SharedBuffer& b) { return b; }
+  qi::Buffer viewAsBuffer(const qilang::SharedBuffer& b) { return b.buffer(); }
 };
 } // testqilang
 
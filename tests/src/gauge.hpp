@@ -0,0 +1,49 @@
+#ifndef TESTQILANG_GAUGE_HPP
+#define TESTQILANG_GAUGE_HPP
+
+#include <src/instrumented_p.hpp>
+#include <qi/clock.hpp>
+
+namespace testqilang
+{
+class GaugeImpl
+{
+public:
+  qi::Future<int> findTruth()
+  {
+    return qi::Future<int>(42);
+  }
+
+  qi::Future<qi::SystemClockTimePoint> whatsTheTime()
+  {
+    return qi::Future<qi::SystemClockTimePoint>(qi::SystemClock::now());
+  }
+
+  void overlord(const std::string& = std::string{})
+  {
+  }
+
+  void overlord(int)
+  {
+  }
+
+  int overlord1()
+  {
+    return 1;
+  }
+
+  int collect(const std::vector<Error>& errors)
+  {
+    return static_cast<int>(errors.size());
+  }
+
+  int square(int x)
+  {
+    return x * x;
+  }
+};
+} // testqilang
+
+QI_REGISTER_IMPLEMENTATION_H(testqilang::Gauge, testqilang::GaugeImpl)
+
+#endif // TESTQILANG_GAUGE_HPP
@@ -2,6 +2,9 @@
 #define TESTQILANG_KINDAMANAGERIMPL_HPP
 
 #include <src/somemix_p.hpp>
+#include <atomic>
+#include <memory>
+#include <qi/async.hpp>
 #include <qi/clock.hpp>
 
 namespace testqilang
@@ -33,9 +36,77 @@ public:
 
   }
 
+  int collect(std::vector<Error> errors)
+  {
+    _errors = std::move(errors);
+    return static_cast<int>(_errors.size());
+  }
+
+  qilang::Stream<std::string> exportLog(int count)
+  {
+    qilang::StreamWriter<std::string> writer(4);
+    writeLog(writer, 0, count);
+    return writer.stream();
+  }
+
+  int square(int x)
+  {
+    return x * x;
+  }
+
+  std::vector<std::string> capabilities()
+  {
+    return { "batch", "cache" };
+  }
+
+  // Tells each read apart.
+  std::string setting(const std::string& key)
+  {
+    return key + "#" + std::to_string(++_settingReads);
+  }
+
+  // Tells each lookup apart, and takes long enough for calls to overlap.
+  qi::Future<std::string> lookup(const std::string& key)
+  {
+    auto lookups = _lookups;
+    return qi::asyncDelay([lookups, key] {
+      return key + "#" + std::to_string(++*lookups);
+    }, qi::MilliSeconds{ 100 });
+  }
+
+  qi::Future<int> ponder(const std::string& question)
+  {
+    return qi::asyncDelay([question] {
+      return static_cast<int>(question.size());
+    }, qi::MilliSeconds{ 100 });
+  }
+
   qi::Signal<float> test;
   qi::Signal<void> nothing;
+  qi::Signal<std::string> settingChanged;
+  qi::Signal<float> moved;
+  qi::Signal<std::string, int, std::string> changed;
   qi::Property<std::vector<float>> current;
+  qi::Property<float> temperature;
+
+private:
+  // Writes the next line once the previous one is buffered.
+  static void writeLog(qilang::StreamWriter<std::string> writer, int line, int count)
+  {
+    if (line == count)
+    {
+      writer.close();
+      return;
+    }
+    writer.write("line " + std::to_string(line)).then([=](qi::Future<void> written) {
+      if (!written.hasError())
+        writeLog(writer, line + 1, count);
+    });
+  }
+
+  std::vector<Error> _errors;
+  std::atomic<int> _settingReads{ 0 };
+  std::shared_ptr<std::atomic<int>> _lookups = std::make_shared<std::atomic<int>>(0);
 };
 } // testqilang
 
@@ -9,6 +9,7 @@ struct PropertyMasterImpl
 {
   qi::Property<int> intProperty;
   qi::Property<boost::optional<float>> optionalProperty;
+  qi::Property<int> strictProperty;
 };
 } // testqilang
 
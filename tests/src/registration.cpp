@@ -1,4 +1,5 @@
 #include <qi/anymodule.hpp>
+#include <testqilang/instrumented.hpp>
 #include <testqilang/somemix.hpp>
 #include <testqilang/somestructs.hpp>
 #include <testqilang/time.hpp>
@@ -6,6 +7,7 @@
 #include "anotherinterfaceimpl.hpp"
 #include "bradpitt.hpp"
 #include "buffy.hpp"
+#include "gauge.hpp"
 #include "ouroboros.hpp"
 #include "pingpong.hpp"
 #include "propertymaster.hpp"
@@ -17,6 +19,7 @@ REGISTER_KINDAMANAGER(testqilang::KindaManagerImpl)
 REGISTER_ANOTHERINTERFACE(testqilang::AnotherInterfaceImpl)
 REGISTER_BRADPITT(testqilang::BradPittImpl)
 REGISTER_BUFFY(testqilang::BuffyImpl)
+REGISTER_GAUGE(testqilang::GaugeImpl)
 REGISTER_TIMELORD(testqilang::TimeLordImpl)
 REGISTER_OUROBOROS(testqilang::OuroborosImpl)
 REGISTER_PING(testqilang::PingImpl)
@@ -56,6 +59,7 @@ void registerTestQiLang(qi::ModuleBuilder* mb)
   mb->advertiseFactory<testqilang::AnotherInterface>("AnotherInterface");
   mb->advertiseFactory<testqilang::BradPitt>("BradPitt");
   mb->advertiseFactory<testqilang::Buffy>("Buffy");
+  mb->advertiseFactory<testqilang::Gauge>("Gauge");
   mb->advertiseFactory<testqilang::SignalMaster>("SignalMaster");
   mb->advertiseFactory<testqilang::PropertyMaster>("PropertyMaster");
   mb->advertiseFactory<testqilang::TimeLord>("TimeLord");
@@ -0,0 +1,189 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/type/dynamicobjectbuilder.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/batch.hpp>
+#include <qilang/parser.hpp>
+#include <testqilang/somemix.hpp>
+
+namespace
+{
+  const auto waitTimeout = qi::Seconds{ 5 };
+
+  using IntOutcome = qilang::detail::BatchOutcome<int>;
+
+  // An object with the batch entry point of `double(x: int) -> int`, failing on negative
+  // numbers, counting the batches.
+  qi::AnyObject makeDoubler(std::shared_ptr<std::vector<std::size_t>> batchSizes)
+  {
+    qi::DynamicObjectBuilder builder;
+    builder.advertiseMethod(qilang::detail::batchMethodName("double"),
+      boost::function<qilang::detail::BatchResults<int>(const std::vector<std::tuple<int>>&)>(
+        [batchSizes](const std::vector<std::tuple<int>>& calls) {
+          batchSizes->push_back(calls.size());
+          qilang::detail::BatchResults<int> results;
+          for (const auto& call : calls)
+          {
+            const int x = std::get<0>(call);
+            if (x < 0)
+              results.push_back(IntOutcome(std::string("negative"), boost::none));
+            else
+              results.push_back(IntOutcome(boost::none, 2 * x));
+          }
+          return results;
+        }));
+    return builder.object();
+  }
+
+  bool parseFails(const std::string& member)
+  {
+    std::istringstream in("package testbatch\ninterface Batched\n" + member + "\nend\n");
+    return qilang::parse(qilang::newFileReader(&in, "batch.idl.qi"))->hasError();
+  }
+}
+
+TEST(Batch, annotationIsChecked)
+{
+  EXPECT_FALSE(parseFails("@batch fn f(x: int) -> int"));
+  EXPECT_FALSE(parseFails("@batch(10, 100) fn f(x: int)"));
+  EXPECT_TRUE(parseFails("@batch sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@batch(1, 2, 3) fn f(x: int)"));
+  EXPECT_TRUE(parseFails("@batch(\"soon\") fn f(x: int)"));
+  EXPECT_TRUE(parseFails("@batch fn f(*args: int)"));
+}
+
+TEST(Batch, batchCallGathersTheResultsInOrder)
+{
+  const std::vector<std::tuple<int, std::string>> calls{ { 1, "a" }, { 2, "b" }, { 3, "c" } };
+  auto results = qilang::detail::batchCall<std::string>(calls, [](int count, const std::string& letter) {
+    std::string repeated;
+    for (int i = 0; i < count; ++i)
+      repeated += letter;
+    return qi::Future<std::string>{ repeated };
+  });
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, results.wait(waitTimeout)) << results.error();
+  ASSERT_EQ(3u, results.value().size());
+  std::vector<std::string> values;
+  for (const auto& outcome : results.value())
+  {
+    EXPECT_FALSE(outcome.first);
+    ASSERT_TRUE(outcome.second);
+    values.push_back(*outcome.second);
+  }
+  EXPECT_EQ((std::vector<std::string>{ "a", "bb", "ccc" }), values);
+}
+
+TEST(Batch, batchCallReportsTheErrorOfEachCall)
+{
+  const std::vector<std::tuple<int>> calls{ { 1 }, { -1 }, { 2 } };
+  auto results = qilang::detail::batchCall<void>(calls, [](int x) {
+    return x < 0 ? qi::makeFutureError<void>("negative") : qi::Future<void>{ nullptr };
+  });
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, results.wait(waitTimeout)) << results.error();
+  ASSERT_EQ(3u, results.value().size());
+  EXPECT_FALSE(results.value()[0]);
+  ASSERT_TRUE(results.value()[1]);
+  EXPECT_EQ("negative", *results.value()[1]);
+  EXPECT_FALSE(results.value()[2]);
+}
+
+TEST(Batch, callsAreSentWhenTheBatchIsFull)
+{
+  auto batchSizes = std::make_shared<std::vector<std::size_t>>();
+  // a window long enough for the calls to only be sent because the batch is full
+  auto batcher = std::make_shared<qilang::detail::Batcher<int, int>>(
+    makeDoubler(batchSizes), "double", qi::Seconds{ 60 }, 3);
+
+  std::vector<qi::Future<int>> futures;
+  for (int i = 0; i < 3; ++i)
+    futures.push_back(batcher->call(std::make_tuple(i)));
+  for (int i = 0; i < 3; ++i)
+  {
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, futures[i].wait(waitTimeout)) << futures[i].error();
+    EXPECT_EQ(2 * i, futures[i].value());
+  }
+  EXPECT_EQ(std::vector<std::size_t>{ 3 }, *batchSizes);
+}
+
+TEST(Batch, failingCallOnlyFailsItself)
+{
+  auto batchSizes = std::make_shared<std::vector<std::size_t>>();
+  auto batcher = std::make_shared<qilang::detail::Batcher<int, int>>(
+    makeDoubler(batchSizes), "double", qi::Seconds{ 60 }, 3);
+
+  auto first = batcher->call(std::make_tuple(1));
+  auto failing = batcher->call(std::make_tuple(-1));
+  auto last = batcher->call(std::make_tuple(3));
+  ASSERT_EQ(qi::FutureState_FinishedWithError, failing.wait(waitTimeout));
+  EXPECT_EQ("negative", failing.error());
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, first.wait(waitTimeout)) << first.error();
+  EXPECT_EQ(2, first.value());
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, last.wait(waitTimeout)) << last.error();
+  EXPECT_EQ(6, last.value());
+  EXPECT_EQ(std::vector<std::size_t>{ 3 }, *batchSizes);
+}
+
+TEST(Batch, callsAreSentAtTheEndOfTheWindow)
+{
+  auto batchSizes = std::make_shared<std::vector<std::size_t>>();
+  auto batcher = std::make_shared<qilang::detail::Batcher<int, int>>(
+    makeDoubler(batchSizes), "double", qi::MilliSeconds{ 10 }, 64);
+
+  auto first = batcher->call(std::make_tuple(20));
+  auto second = batcher->call(std::make_tuple(21));
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, second.wait(waitTimeout)) << second.error();
+  EXPECT_EQ(40, first.value());
+  EXPECT_EQ(42, second.value());
+  EXPECT_EQ(std::vector<std::size_t>{ 2 }, *batchSizes);
+}
+
+TEST(Batch, pendingCallsAreSentOnDestruction)
+{
+  auto batchSizes = std::make_shared<std::vector<std::size_t>>();
+  auto batcher = std::make_shared<qilang::detail::Batcher<int, int>>(
+    makeDoubler(batchSizes), "double", qi::Seconds{ 60 }, 64);
+
+  auto result = batcher->call(std::make_tuple(4));
+  batcher.reset();
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, result.wait(waitTimeout)) << result.error();
+  EXPECT_EQ(8, result.value());
+}
+
+TEST(Batch, generatedMethodIsBatchedByRemoteClients)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  p.server()->registerService("KindaManager", module.call<qi::AnyObject>("KindaManager"));
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+
+  std::vector<qi::Future<int>> futures;
+  for (int i = 0; i < 40; ++i)
+    futures.push_back(km->async().square(i));
+  for (int i = 0; i < 40; ++i)
+  {
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, futures[i].wait(waitTimeout)) << futures[i].error();
+    EXPECT_EQ(i * i, futures[i].value());
+  }
+  EXPECT_EQ(49, km->square(7));
+}
+
+TEST(Batch, generatedMethodKeepsItsRegularEntryPoint)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  p.server()->registerService("KindaManager", module.call<qi::AnyObject>("KindaManager"));
+  qi::AnyObject km = p.client()->service("KindaManager").value();
+
+  EXPECT_EQ(9, km.call<int>("square", 3));
+  const std::vector<std::tuple<int>> calls{ { 2 }, { 5 } };
+  const auto outcomes = km.call<qilang::detail::BatchResults<int>>("square__batch", calls);
+  ASSERT_EQ(2u, outcomes.size());
+  EXPECT_EQ(4, outcomes[0].second.value_or(0));
+  EXPECT_EQ(25, outcomes[1].second.value_or(0));
+}
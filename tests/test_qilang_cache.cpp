@@ -0,0 +1,205 @@
+#include <memory>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/os.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/cache.hpp>
+#include <qilang/parser.hpp>
+#include <testqilang/somemix.hpp>
+
+namespace
+{
+  const auto waitTimeout = qi::Seconds{ 5 };
+
+  using NoKey = qilang::detail::CallKey<>;
+
+  bool parseFails(const std::string& members)
+  {
+    std::istringstream in("package testcache\ninterface Cached\n" + members + "\nend\n");
+    return qilang::parse(qilang::newFileReader(&in, "cache.idl.qi"))->hasError();
+  }
+
+  // A call of the cached method counting how many times it is really made.
+  struct CountedCall
+  {
+    std::shared_ptr<int> count = std::make_shared<int>(0);
+
+    qi::Future<int> operator()() const
+    {
+      return qi::Future<int>{ ++*count };
+    }
+  };
+}
+
+TEST(Cache, annotationsAreChecked)
+{
+  EXPECT_FALSE(parseFails("@pure fn f() -> int"));
+  EXPECT_FALSE(parseFails("@cached(100) fn f(x: int) -> int"));
+  EXPECT_FALSE(parseFails("@cached(100, changed) fn f(x: int) -> int\nsig changed()"));
+  EXPECT_TRUE(parseFails("@pure sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@pure fn f(x: int)"));
+  EXPECT_TRUE(parseFails("@cached fn f(x: int) -> int"));
+  EXPECT_TRUE(parseFails("@cached(0) fn f(x: int) -> int"));
+  EXPECT_TRUE(parseFails("@cached(100, changed) fn f(x: int) -> int"));
+  EXPECT_TRUE(parseFails("@cached(100, f) fn f(x: int) -> int"));
+  EXPECT_TRUE(parseFails("@batch @cached(100) fn f(x: int) -> int"));
+  EXPECT_FALSE(parseFails("@idempotent fn f(x: int)"));
+  EXPECT_TRUE(parseFails("@idempotent sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@idempotent(1) fn f(x: int)"));
+  EXPECT_TRUE(parseFails("@idempotent @pure fn f() -> int"));
+  EXPECT_FALSE(parseFails("@uncached prop p(x: int)"));
+  EXPECT_TRUE(parseFails("@uncached fn f(x: int)"));
+}
+
+TEST(Cache, callKeysWithoutStdHashAreHashedByValue)
+{
+  using Key = qilang::detail::CallKey<testqilang::Error, std::vector<int>>;
+  const Key key{ testqilang::Error{ 1, "failed" }, { 1, 2 } };
+  const Key same{ testqilang::Error{ 1, "failed" }, { 1, 2 } };
+  const Key other{ testqilang::Error{ 2, "failed" }, { 1, 2 } };
+  EXPECT_EQ(qilang::detail::CallKeyHash<Key>{}(key), qilang::detail::CallKeyHash<Key>{}(same));
+  EXPECT_TRUE(qilang::detail::CallKeyEqual<Key>{}(key, same));
+  EXPECT_FALSE(qilang::detail::CallKeyEqual<Key>{}(key, other));
+}
+
+TEST(Cache, resultsAreKeptByArguments)
+{
+  using Key = qilang::detail::CallKey<int, std::string>;
+  auto cache = std::make_shared<qilang::detail::ResultCache<int, Key>>();
+  CountedCall call;
+
+  EXPECT_EQ(1, cache->get(std::make_tuple(1, std::string("a")), call).value());
+  EXPECT_EQ(1, cache->get(std::make_tuple(1, std::string("a")), call).value());
+  EXPECT_EQ(2, cache->get(std::make_tuple(2, std::string("a")), call).value());
+  EXPECT_EQ(2, *call.count);
+
+  cache->clear();
+  EXPECT_EQ(3, cache->get(std::make_tuple(1, std::string("a")), call).value());
+}
+
+TEST(Cache, resultsExpire)
+{
+  auto cache = std::make_shared<qilang::detail::ResultCache<int, NoKey>>(qi::MilliSeconds{ 10 });
+  CountedCall call;
+
+  EXPECT_EQ(1, cache->get(std::make_tuple(), call).value());
+  qi::os::msleep(20);
+  EXPECT_EQ(2, cache->get(std::make_tuple(), call).value());
+}
+
+TEST(Cache, pendingCallIsShared)
+{
+  auto cache = std::make_shared<qilang::detail::ResultCache<int, qilang::detail::CallKey<int>>>();
+  qi::Promise<int> remote;
+  int calls = 0;
+  auto call = [&] { ++calls; return remote.future(); };
+
+  auto first = cache->get(std::make_tuple(7), call);
+  auto second = cache->get(std::make_tuple(7), call);
+  EXPECT_FALSE(first.isFinished());
+  remote.setValue(49);
+  EXPECT_EQ(49, first.value());
+  EXPECT_EQ(49, second.value());
+  EXPECT_EQ(1, calls);
+}
+
+TEST(Cache, errorsAreNotKept)
+{
+  auto cache = std::make_shared<qilang::detail::ResultCache<int, NoKey>>();
+  auto failed = cache->get(std::make_tuple(), [] { return qi::makeFutureError<int>("offline"); });
+  ASSERT_EQ(qi::FutureState_FinishedWithError, failed.wait(waitTimeout));
+  EXPECT_EQ("offline", failed.error());
+
+  auto retried = cache->get(std::make_tuple(), [] { return qi::Future<int>{ 42 }; });
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, retried.wait(waitTimeout)) << retried.error();
+  EXPECT_EQ(42, retried.value());
+}
+
+TEST(Cache, identicalPendingCallsAreShared)
+{
+  auto flight = std::make_shared<qilang::detail::SingleFlight<int, qilang::detail::CallKey<int>>>();
+  qi::Promise<int> remote;
+  int calls = 0;
+  auto call = [&] { ++calls; return remote.future(); };
+
+  auto first = flight->call(std::make_tuple(7), call);
+  auto second = flight->call(std::make_tuple(7), call);
+  auto other = flight->call(std::make_tuple(8), [] { return qi::Future<int>{ 64 }; });
+  remote.setValue(49);
+  EXPECT_EQ(49, first.value());
+  EXPECT_EQ(49, second.value());
+  EXPECT_EQ(64, other.value());
+  EXPECT_EQ(1, calls);
+}
+
+TEST(Cache, finishedCallsAreNotShared)
+{
+  auto flight = std::make_shared<qilang::detail::SingleFlight<void, NoKey>>();
+  int calls = 0;
+  auto call = [&] { ++calls; return qi::Future<void>{ nullptr }; };
+
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, flight->call(std::make_tuple(), call).wait(waitTimeout));
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, flight->call(std::make_tuple(), call).wait(waitTimeout));
+  EXPECT_EQ(2, calls);
+}
+
+TEST(Cache, generatedMethodIsCachedByRemoteClients)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  p.server()->registerService("KindaManager", module.call<qi::AnyObject>("KindaManager"));
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+
+  const std::string first = km->setting("volume");
+  EXPECT_EQ("volume#", first.substr(0, 7));
+  EXPECT_EQ(first, km->setting("volume"));
+  EXPECT_EQ(first, km->async().setting("volume").value());
+  EXPECT_NE(first, km->setting("language"));
+  EXPECT_EQ((std::vector<std::string>{ "batch", "cache" }), km->capabilities());
+}
+
+TEST(Cache, generatedMethodIsInvalidatedBySignal)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  p.server()->registerService("KindaManager", module.call<qi::AnyObject>("KindaManager"));
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+
+  const std::string first = km->setting("volume");
+  // the proxy subscribes to the signal asynchronously: emit it until the value is read again
+  const auto deadline = qi::SteadyClock::now() + waitTimeout;
+  std::string current = first;
+  while (current == first && qi::SteadyClock::now() < deadline)
+  {
+    QI_EMIT km->settingChanged("volume");
+    qi::os::msleep(10);
+    current = km->setting("volume");
+  }
+  EXPECT_NE(first, current);
+}
+
+TEST(Cache, generatedMethodSharesPendingCallsOfRemoteClients)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  p.server()->registerService("KindaManager", module.call<qi::AnyObject>("KindaManager"));
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+
+  std::vector<qi::Future<std::string>> futures;
+  for (int i = 0; i < 20; ++i)
+    futures.push_back(km->async().lookup("volume"));
+  auto other = km->async().lookup("language");
+  for (auto& future : futures)
+    ASSERT_EQ(qi::FutureState_FinishedWithValue, future.wait(waitTimeout)) << future.error();
+  const std::string first = futures.front().value();
+  for (auto& future : futures)
+    EXPECT_EQ(first, future.value());
+  EXPECT_NE(first, other.value());
+  // the call is finished: the next one is sent again
+  EXPECT_NE(first, km->lookup("volume"));
+}
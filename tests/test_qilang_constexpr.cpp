@@ -0,0 +1,215 @@
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <gtest/gtest.h>
+#include <qi/anyvalue.hpp>
+#include <qilang/node.hpp>
+#include <qilang/formatter.hpp>
+#include <qilang/parser.hpp>
+#include <testqilang/somemix.hpp>
+
+namespace {
+  qilang::ExprNodePtr literal(const qilang::LiteralNodePtr& value) {
+    return boost::make_shared<qilang::LiteralExprNode>(value, qilang::Location());
+  }
+
+  qilang::ExprNodePtr integer(qi::int64_t value) {
+    return literal(boost::make_shared<qilang::IntLiteralNode>(static_cast<qi::uint64_t>(value), qilang::Location(), value < 0));
+  }
+
+  qilang::ExprNodePtr binary(const qilang::ExprNodePtr& left, qilang::BinaryOpCode op, const qilang::ExprNodePtr& right) {
+    return boost::make_shared<qilang::BinaryOpExprNode>(left, right, op, qilang::Location());
+  }
+
+  qilang::TypeExprNodePtr builtin(qilang::BuiltinType type, const std::string& name) {
+    return boost::make_shared<qilang::BuiltinTypeExprNode>(type, name, qilang::Location());
+  }
+
+  // the value of the single const declared by `source`
+  qilang::LiteralNodePtr parseConst(const std::string& source, bool& error) {
+    std::istringstream in("package testconst\n" + source + "\n");
+    qilang::ParseResultPtr result = qilang::parse(qilang::newFileReader(&in, "const.idl.qi"));
+    error = result->hasError();
+    for (unsigned i = 0; i < result->ast.size(); ++i) {
+      qilang::ConstDeclNode* decl = dynamic_cast<qilang::ConstDeclNode*>(result->ast.at(i).get());
+      if (decl)
+        return decl->data;
+    }
+    return qilang::LiteralNodePtr();
+  }
+}
+
+TEST(TestConstExpr, foldArithmetic) {
+  qilang::ExprNodePtr expr = binary(binary(integer(1), qilang::BinaryOpCode_Plus, integer(2)),
+                                    qilang::BinaryOpCode_Multiply, integer(-4));
+  qilang::LiteralNodePtr value = qilang::evalConstExpr(expr);
+
+  ASSERT_EQ(qilang::NodeType_IntData, value->type());
+  qilang::IntLiteralNode* result = static_cast<qilang::IntLiteralNode*>(value.get());
+  EXPECT_TRUE(result->negative());
+  EXPECT_EQ(-12, static_cast<qi::int64_t>(result->value));
+  EXPECT_STREQ("-12", qilang::format(value).c_str());
+}
+
+TEST(TestConstExpr, foldUnary) {
+  qilang::ExprNodePtr expr = boost::make_shared<qilang::UnaryOpExprNode>(integer(0), qilang::UnaryOpCode_Complement, qilang::Location());
+  qilang::LiteralNodePtr value = qilang::evalConstExpr(expr);
+
+  ASSERT_EQ(qilang::NodeType_IntData, value->type());
+  EXPECT_EQ(-1, static_cast<qi::int64_t>(static_cast<qilang::IntLiteralNode*>(value.get())->value));
+}
+
+TEST(TestConstExpr, foldStrings) {
+  qilang::ExprNodePtr left = literal(boost::make_shared<qilang::StringLiteralNode>("foo", qilang::Location()));
+  qilang::ExprNodePtr right = literal(boost::make_shared<qilang::StringLiteralNode>("bar", qilang::Location()));
+  qilang::LiteralNodePtr value = qilang::evalConstExpr(binary(left, qilang::BinaryOpCode_Plus, right));
+
+  ASSERT_EQ(qilang::NodeType_StringData, value->type());
+  EXPECT_EQ("foobar", static_cast<qilang::StringLiteralNode*>(value.get())->value);
+}
+
+TEST(TestConstExpr, foldErrors) {
+  EXPECT_THROW(qilang::evalConstExpr(binary(integer(1), qilang::BinaryOpCode_Divide, integer(0))), std::runtime_error);
+  qilang::ExprNodePtr str = literal(boost::make_shared<qilang::StringLiteralNode>("foo", qilang::Location()));
+  EXPECT_THROW(qilang::evalConstExpr(binary(str, qilang::BinaryOpCode_Minus, integer(1))), std::runtime_error);
+}
+
+TEST(TestConstExpr, foldNonFiniteFloats) {
+  const auto floating = [](double value) {
+    return literal(boost::make_shared<qilang::FloatLiteralNode>(value, qilang::Location()));
+  };
+  EXPECT_THROW(qilang::evalConstExpr(binary(floating(1.0), qilang::BinaryOpCode_Divide, floating(0.0))), std::runtime_error);
+  EXPECT_THROW(qilang::evalConstExpr(binary(floating(0.0), qilang::BinaryOpCode_Divide, floating(0.0))), std::runtime_error);
+  EXPECT_THROW(qilang::evalConstExpr(binary(integer(1), qilang::BinaryOpCode_Divide, floating(0.0))), std::runtime_error);
+  EXPECT_THROW(qilang::evalConstExpr(binary(floating(1e300), qilang::BinaryOpCode_Multiply, floating(1e300))), std::runtime_error);
+  EXPECT_THROW(qilang::evalConstExpr(binary(floating(-1.7e308), qilang::BinaryOpCode_Minus, floating(1.7e308))), std::runtime_error);
+
+  bool error = false;
+  parseConst("const Infinite = 1.0 / 0.0", error);
+  EXPECT_TRUE(error);
+  parseConst("const Huge float64 = 1e300 * 1e300", error);
+  EXPECT_TRUE(error);
+  qilang::LiteralNodePtr value = parseConst("const Half = 1.0 / 2", error);
+  EXPECT_FALSE(error);
+  ASSERT_TRUE(value);
+  EXPECT_EQ(0.5, static_cast<qilang::FloatLiteralNode*>(value.get())->value);
+}
+
+TEST(TestConstExpr, checkConstType) {
+  qilang::LiteralNodePtr big = qilang::evalConstExpr(integer(300));
+  qilang::LiteralNodePtr negative = qilang::evalConstExpr(integer(-1));
+
+  EXPECT_EQ("", qilang::checkConstType(builtin(qilang::BuiltinType_Int16, "int16"), big));
+  EXPECT_NE("", qilang::checkConstType(builtin(qilang::BuiltinType_UInt8, "uint8"), big));
+  EXPECT_NE("", qilang::checkConstType(builtin(qilang::BuiltinType_UInt32, "uint32"), negative));
+  EXPECT_NE("", qilang::checkConstType(builtin(qilang::BuiltinType_String, "str"), big));
+  EXPECT_EQ("", qilang::checkConstType(builtin(qilang::BuiltinType_Float64, "float64"), big));
+}
+
+TEST(TestConstExpr, inferConstType) {
+  bool error = false;
+  EXPECT_STREQ("int", qilang::format(qilang::inferConstType(parseConst("const A = 1", error))).c_str());
+  EXPECT_STREQ("int64", qilang::format(qilang::inferConstType(parseConst("const B = 4294967296", error))).c_str());
+  EXPECT_STREQ("[]int64", qilang::format(qilang::inferConstType(parseConst("const C = [1, 4294967296]", error))).c_str());
+  EXPECT_FALSE(qilang::inferConstType(parseConst("const D = [1, \"one\"]", error)));
+  EXPECT_FALSE(error);
+}
+
+TEST(TestConstExpr, parseFolded) {
+  bool error = false;
+  qilang::LiteralNodePtr value = parseConst("const Mask uint32 = (1 + 2) * 4 | 1", error);
+
+  EXPECT_FALSE(error);
+  ASSERT_TRUE(value);
+  EXPECT_STREQ("13", qilang::format(value).c_str());
+}
+
+TEST(TestConstExpr, parseOutOfRange) {
+  bool error = false;
+  parseConst("const Small uint8 = 255 + 1", error);
+
+  EXPECT_TRUE(error);
+}
+
+TEST(TestConstExpr, parseLimits) {
+  bool error = false;
+  qilang::LiteralNodePtr value = parseConst("const Big = 9223372036854775808", error);
+  EXPECT_FALSE(error);
+  ASSERT_TRUE(value);
+  EXPECT_FALSE(static_cast<qilang::IntLiteralNode*>(value.get())->negative());
+  EXPECT_STREQ("uint64", qilang::format(qilang::inferConstType(value)).c_str());
+  EXPECT_STREQ("9223372036854775808", qilang::format(value).c_str());
+
+  value = parseConst("const Max = 18446744073709551615", error);
+  EXPECT_FALSE(error);
+  ASSERT_TRUE(value);
+  EXPECT_STREQ("uint64", qilang::format(qilang::inferConstType(value)).c_str());
+  EXPECT_STREQ("18446744073709551615", qilang::format(value).c_str());
+  EXPECT_EQ(std::numeric_limits<qi::uint64_t>::max(), qilang::toAnyValue(value).to<qi::uint64_t>());
+
+  value = parseConst("const TypedMax uint64 = 18446744073709551615", error);
+  EXPECT_FALSE(error);
+
+  value = parseConst("const Min int64 = -9223372036854775808", error);
+  EXPECT_FALSE(error);
+  ASSERT_TRUE(value);
+  EXPECT_TRUE(static_cast<qilang::IntLiteralNode*>(value.get())->negative());
+  EXPECT_STREQ("int64", qilang::format(qilang::inferConstType(value)).c_str());
+  EXPECT_STREQ("-9223372036854775808", qilang::format(value).c_str());
+  EXPECT_EQ(std::numeric_limits<qi::int64_t>::min(), qilang::toAnyValue(value).to<qi::int64_t>());
+
+  parseConst("const TooBig int64 = 9223372036854775808", error);
+  EXPECT_TRUE(error);
+  parseConst("const BelowMin = -9223372036854775808 - 1", error);
+  EXPECT_TRUE(error);
+  parseConst("const AboveMax = 18446744073709551615 + 1", error);
+  EXPECT_TRUE(error);
+}
+
+TEST(TestConstExpr, toAnyValueTuple) {
+  qilang::LiteralNodePtrVector values;
+  values.push_back(boost::make_shared<qilang::IntLiteralNode>(42, qilang::Location()));
+  values.push_back(boost::make_shared<qilang::StringLiteralNode>("foo", qilang::Location()));
+  qilang::LiteralNodePtr tuple = boost::make_shared<qilang::TupleLiteralNode>(values, qilang::Location());
+
+  qi::AnyValue value = qilang::toAnyValue(tuple);
+  ASSERT_EQ(qi::TypeKind_Tuple, value.kind());
+  EXPECT_EQ(2u, value.size());
+  EXPECT_EQ(42, value[0].toInt());
+  EXPECT_EQ("foo", value[1].toString());
+  // literals are immutable: the conversion is cached
+  EXPECT_EQ(value, qilang::toAnyValue(tuple));
+}
+
+TEST(TestConstExpr, toAnyValueDict) {
+  qilang::LiteralNodePtrPairVector values;
+  values.push_back(std::make_pair(
+      boost::make_shared<qilang::StringLiteralNode>("answer", qilang::Location()),
+      qilang::evalConstExpr(integer(-42))));
+  qilang::LiteralNodePtr dict = boost::make_shared<qilang::DictLiteralNode>(values, qilang::Location());
+
+  qi::AnyValue value = qilang::toAnyValue(dict);
+  ASSERT_EQ(qi::TypeKind_Map, value.kind());
+  std::map<std::string, qi::int64_t> map = value.to<std::map<std::string, qi::int64_t> >();
+  ASSERT_EQ(1u, map.size());
+  EXPECT_EQ(-42, map["answer"]);
+}
+
+// The constants of the generated headers are usable at compile time
+static_assert(testqilang::MaxSpeed == 5.0, "");
+static_assert(testqilang::Retries == 3, "");
+static_assert(std::string_view(testqilang::Greeting) == "hello", "");
+static_assert(testqilang::Primes.size() == 4 && testqilang::Primes[3] == 7, "");
+static_assert(std::string_view(testqilang::Sides[1]) == "right", "");
+
+TEST(TestConstExpr, generatedConstants) {
+  EXPECT_TRUE((std::is_same<const std::uint8_t, decltype(testqilang::Retries)>::value));
+  // strings convert to whatever the consumers use
+  EXPECT_TRUE((std::is_same<const char[6], decltype(testqilang::Greeting)>::value));
+  const std::string greeting = testqilang::Greeting;
+  EXPECT_EQ("hello", greeting);
+  EXPECT_EQ(std::string("left"), std::string(testqilang::Sides[0]));
+}
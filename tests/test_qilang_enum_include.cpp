@@ -1,3 +1,81 @@
+#include <type_traits>
+#include <gtest/gtest.h>
+#include <qi/binarycodec.hpp>
 #include <testqilang/someenums.hpp>
 
 testqilang::BlablaPolicy policy;
+
+// Check the enums declared with an underlying type
+TEST(Enum, underlyingTypeSetsTheStorage)
+{
+  static_assert(std::is_same<std::uint8_t, std::underlying_type<testqilang::Mode>::type>::value, "");
+  EXPECT_EQ(1u, sizeof(testqilang::Mode));
+  EXPECT_EQ("C", qi::typeOf<testqilang::Mode>()->signature().toString());
+}
+
+TEST(Enum, underlyingTypeRoundTripsThroughBinaryCodec)
+{
+  qi::Buffer buffer;
+  qi::encodeBinary(&buffer, qi::AutoAnyReference(testqilang::Mode::Active));
+  EXPECT_EQ(1u, buffer.totalSize());
+
+  testqilang::Mode decoded = testqilang::Mode::Off;
+  qi::BufferReader reader(buffer);
+  qi::decodeBinary(&reader, &decoded);
+  EXPECT_EQ(testqilang::Mode::Active, decoded);
+  EXPECT_EQ(2, qi::AnyReference::from(decoded).toInt());
+}
+
+// Check the flags
+TEST(Flags, valuesArePowersOfTwo)
+{
+  static_assert(std::is_same<qi::uint32_t, std::underlying_type<testqilang::Capabilities>::type>::value, "");
+  static_assert(static_cast<int>(testqilang::Capabilities::Camera) == 1, "");
+  static_assert(static_cast<int>(testqilang::Capabilities::Arm) == 2, "");
+  static_assert(static_cast<int>(testqilang::Capabilities::Wheels) == 4, "");
+}
+
+TEST(Flags, operatorsAreConstexpr)
+{
+  using testqilang::Capabilities;
+  constexpr auto set = Capabilities::Camera | Capabilities::Wheels;
+  static_assert(has(set, Capabilities::Camera), "");
+  static_assert(!has(set, Capabilities::Arm), "");
+  static_assert(has(set, Capabilities::Camera | Capabilities::Wheels), "");
+  static_assert((set & Capabilities::Wheels) == Capabilities::Wheels, "");
+  static_assert((set ^ Capabilities::Camera) == Capabilities::Wheels, "");
+  static_assert(~set == Capabilities::Arm, "");
+}
+
+TEST(Flags, registeredAsAnInteger)
+{
+  const auto set = testqilang::Capabilities::Arm | testqilang::Capabilities::Wheels;
+  EXPECT_EQ("I", qi::typeOf<testqilang::Capabilities>()->signature().toString());
+  EXPECT_EQ(6, qi::AnyReference::from(set).toInt());
+}
+
+// Check the generated conversions between enum values and names
+TEST(Enum, convertsToStringAtCompileTime)
+{
+  static_assert(toString(testqilang::Mode::Idle) == "Idle", "");
+  static_assert(toString(testqilang::BlablaPolicy::InterruptOthers) == "InterruptOthers", "");
+  EXPECT_TRUE(toString(static_cast<testqilang::Mode>(42)).empty());
+}
+
+TEST(Enum, convertsFromString)
+{
+  testqilang::Mode mode = testqilang::Mode::Off;
+  EXPECT_TRUE(fromString("Active", mode));
+  EXPECT_EQ(testqilang::Mode::Active, mode);
+  EXPECT_TRUE(fromString("Off", mode));
+  EXPECT_EQ(testqilang::Mode::Off, mode);
+  EXPECT_FALSE(fromString("Sleeping", mode));
+  EXPECT_FALSE(fromString("", mode));
+  EXPECT_EQ(testqilang::Mode::Off, mode);
+
+  for (const auto& entry : testqilang::detail::ModeNames) {
+    testqilang::Mode value = testqilang::Mode::Off;
+    EXPECT_TRUE(fromString(entry.first, value));
+    EXPECT_EQ(entry.first, toString(value));
+  }
+}
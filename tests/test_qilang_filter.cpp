@@ -0,0 +1,174 @@
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/clock.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/filter.hpp>
+#include <qilang/parser.hpp>
+#include <testqilang/somemix.hpp>
+
+namespace
+{
+  const auto waitTimeout = qi::Seconds{ 5 };
+
+  bool parseFails(const std::string& members)
+  {
+    std::istringstream in("package testfilter\ninterface Filtered\n" + members + "\nend\n");
+    return qilang::parse(qilang::newFileReader(&in, "filter.idl.qi"))->hasError();
+  }
+
+  // Keys of the emissions of `changed` received by a subscriber, which is called asynchronously.
+  class ReceivedKeys
+  {
+  public:
+    void operator()(const std::string& key, int, const std::string&)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _keys.push_back(key);
+    }
+
+    // The keys received, once there are `count` of them or the timeout is over.
+    std::vector<std::string> waitFor(std::size_t count)
+    {
+      const auto deadline = qi::SteadyClock::now() + waitTimeout;
+      while (keys().size() < count && qi::SteadyClock::now() < deadline)
+        std::this_thread::sleep_for(qi::MilliSeconds{ 5 });
+      return keys();
+    }
+
+    std::vector<std::string> keys()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _keys;
+    }
+
+  private:
+    std::mutex _mutex;
+    std::vector<std::string> _keys;
+  };
+}
+
+TEST(Filter, annotationsAreChecked)
+{
+  EXPECT_FALSE(parseFails("@filterable(x) sig s(x: int)"));
+  EXPECT_FALSE(parseFails("@filterable(x, y) sig s(x: int, y: str)"));
+  EXPECT_TRUE(parseFails("@filterable sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@filterable(y) sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@filterable(1) sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@filterable(x) prop p(x: int)"));
+  EXPECT_TRUE(parseFails("@filterable(x) fn f(x: int)"));
+}
+
+TEST(Filter, predicateChecksTheBounds)
+{
+  const std::vector<std::string> parameters{ "key", "level", "" };
+  qilang::detail::SignalFilter filter;
+  qilang::detail::filterBetween(filter, "key", std::string("volume"), std::string("volume"));
+  qilang::detail::filterAtLeast(filter, "level", 2);
+  const qilang::detail::SignalPredicate predicate(filter, parameters);
+
+  EXPECT_TRUE(predicate(std::string("volume"), 2, std::string()));
+  EXPECT_TRUE(predicate(std::string("volume"), 7, std::string("loud")));
+  EXPECT_FALSE(predicate(std::string("volume"), 1, std::string()));
+  EXPECT_FALSE(predicate(std::string("language"), 2, std::string()));
+
+  EXPECT_TRUE(qilang::detail::SignalPredicate({}, parameters)(std::string("language"), 0, std::string()));
+}
+
+TEST(Filter, onlyFilterableParametersAreFiltered)
+{
+  const std::vector<std::string> parameters{ "key", "level", "" };
+  qilang::detail::SignalFilter filter;
+  qilang::detail::filterAtMost(filter, "note", std::string("z"));
+  EXPECT_THROW(qilang::detail::SignalPredicate(filter, parameters), std::runtime_error);
+  EXPECT_THROW(qilang::detail::SignalPredicate({ { "", {} } }, parameters), std::runtime_error);
+}
+
+TEST(Filter, generatedSignalIsFilteredForLocalSubscribers)
+{
+  auto module = qi::import("testqilang_module");
+  testqilang::KindaManagerPtr km = module.call<qi::AnyObject>("KindaManager");
+  ReceivedKeys received;
+  const qi::SignalLink link = km->connectChanged(testqilang::KindaManagerChangedFilter().levelAtLeast(2),
+                                                 [&](const std::string& key, int level, const std::string& note) {
+                                                   received(key, level, note);
+                                                 }).value();
+
+  QI_EMIT km->changed("volume", 1, "");
+  QI_EMIT km->changed("language", 3, "");
+  EXPECT_EQ(std::vector<std::string>{ "language" }, received.waitFor(1));
+
+  km->disconnectChanged(link).value();
+  QI_EMIT km->changed("brightness", 5, "");
+  std::this_thread::sleep_for(qi::MilliSeconds{ 50 });
+  EXPECT_EQ(1u, received.keys().size());
+}
+
+TEST(Filter, generatedSignalIsFilteredByTheServiceForRemoteSubscribers)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  testqilang::KindaManagerPtr service = module.call<qi::AnyObject>("KindaManager");
+  p.server()->registerService("KindaManager", service);
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+  ReceivedKeys received;
+  const auto filter = testqilang::KindaManagerChangedFilter().keyIs("volume").levelBetween(1, 3);
+  const qi::SignalLink link = km->connectChanged(filter, [&](const std::string& key, int level, const std::string& note) {
+                                                   received(key, level, note);
+                                                 }).value();
+
+  QI_EMIT service->changed("language", 2, "");
+  QI_EMIT service->changed("volume", 4, "");
+  QI_EMIT service->changed("volume", 2, "");
+  EXPECT_EQ(std::vector<std::string>{ "volume" }, received.waitFor(1));
+
+  km->disconnectChanged(link).value();
+  QI_EMIT service->changed("volume", 2, "");
+  std::this_thread::sleep_for(qi::MilliSeconds{ 50 });
+  EXPECT_EQ(1u, received.keys().size());
+}
+
+TEST(Filter, remoteClientsCanOnlyDisconnectTheirFilteredSubscribers)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  testqilang::KindaManagerPtr service = module.call<qi::AnyObject>("KindaManager");
+  p.server()->registerService("KindaManager", service);
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+  ReceivedKeys received;
+  const qi::SignalLink local = service->changed.connect([&](const std::string& key, int level, const std::string& note) {
+    received(key, level, note);
+  });
+
+  // a subscriber of the service itself cannot be disconnected by the subscription methods
+  EXPECT_TRUE(km->disconnectChanged(local).hasError());
+  const qi::SignalLink link = km->connectChanged(testqilang::KindaManagerChangedFilter(),
+                                                 [](const std::string&, int, const std::string&) {}).value();
+  km->disconnectChanged(link).value();
+  EXPECT_TRUE(km->disconnectChanged(link).hasError());
+
+  QI_EMIT service->changed("volume", 2, "");
+  EXPECT_EQ(std::vector<std::string>{ "volume" }, received.waitFor(1));
+}
+
+TEST(Filter, remoteSubscribersAreDisconnectedWithTheirSession)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  testqilang::KindaManagerPtr service = module.call<qi::AnyObject>("KindaManager");
+  p.server()->registerService("KindaManager", service);
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+  km->connectChanged(testqilang::KindaManagerChangedFilter(), [](const std::string&, int, const std::string&) {}).value();
+  ASSERT_TRUE(service->changed.hasSubscribers());
+
+  p.client()->close().value();
+  const auto deadline = qi::SteadyClock::now() + waitTimeout;
+  while (service->changed.hasSubscribers() && qi::SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(qi::MilliSeconds{ 5 });
+  EXPECT_FALSE(service->changed.hasSubscribers());
+}
@@ -1,6 +1,8 @@
+#include <sstream>
 #include <gtest/gtest.h>
 
 #include <qi/anymodule.hpp>
+#include <qilang/parser.hpp>
 #include <testsession/testsession.hpp>
 #include <testqilang/somemix.hpp>
 #include <testqilang/somestructs.hpp>
@@ -9,6 +11,15 @@
 
 const auto waitTimeout = qi::Seconds{ 5 };
 
+namespace
+{
+  bool parseFails(const std::string& declarations)
+  {
+    std::istringstream in("package testannotations\n" + declarations + "\n");
+    return qilang::parse(qilang::newFileReader(&in, "annotations.idl.qi"))->hasError();
+  }
+}
+
 class QiLangFunction: public ::testing::Test
 {
 protected:
@@ -43,6 +54,31 @@ TEST_F(QiLangFunction, OverloadedMethodsWithDifferentDeclarations)
   km->overlord(42);
 }
 
+TEST_F(QiLangFunction, SinkParameterIsTakenByValue)
+{
+  auto km = _testqilang.call<KindaManagerPtr>("KindaManager");
+  std::vector<Error> errors(3);
+  EXPECT_EQ(3, km->collect(std::move(errors)));
+  EXPECT_EQ(0, km->collect(std::vector<Error>{}));
+}
+
+TEST(QiLangAnnotations, UnknownOrMisplacedAnnotationsAreRejected)
+{
+  EXPECT_FALSE(parseFails("interface I\nfn f(@sink x: Vec<str>)\nend"));
+  EXPECT_FALSE(parseFails("@columns\nstruct S\nx: int\nend"));
+  EXPECT_TRUE(parseFails("interface I\n@frobnicate\nfn f()\nend"));
+  EXPECT_TRUE(parseFails("interface I\nfn f(@frobnicate x: int)\nend"));
+  EXPECT_TRUE(parseFails("@frobnicate\nstruct S\nx: int\nend"));
+  EXPECT_TRUE(parseFails("interface I\n@sink\nfn f(x: int)\nend"));
+  EXPECT_TRUE(parseFails("interface I\nsig s(@sink x: int)\nend"));
+  EXPECT_TRUE(parseFails("interface I\nfn f(@sink(1) x: int)\nend"));
+  EXPECT_TRUE(parseFails("interface I\nfn f(@idempotent x: int)\nend"));
+  EXPECT_TRUE(parseFails("interface I\n@columns\nfn f() -> int\nend"));
+  EXPECT_TRUE(parseFails("@columns(1)\nstruct S\nx: int\nend"));
+  EXPECT_TRUE(parseFails("@pure\nstruct S\nx: int\nend"));
+  EXPECT_TRUE(parseFails("@columnsof(T)\nstruct S\nx: int\nend"));
+}
+
 TEST_F(QiLangFunction, MethodOfAnActor)
 {
   _testqilang.call<BradPittPtr>("BradPitt")->act();
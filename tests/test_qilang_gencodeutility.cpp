@@ -146,36 +146,95 @@ TYPED_TEST(QiLangSafeMemberAsyncActor, safeMemberAsyncConcurrentCalls)
   }
 }
 
-// TODO: when C++ > 11, uncomment the test below checking if move-only args are allowed.
-// Then fix it using C++14's lambda capture expressions to move the arguments in the closure
-// implemented in `safeMemberAsync()`.
-//
-//namespace {
-//  struct INeedMoveOnlyArgs
-//  {
-//    std::unique_ptr<int> value;
-//
-//    void setValue(std::unique_ptr<int> newValue)
-//    {
-//      value = std::move(newValue);
-//    }
-//  };
-//}
-//
-//TEST(QiLangCommon, safeMemberAsyncAllowsMoveOnlyArgs)
-//{
-//  using qilang::detail::safeMemberAsync;
-//  using Ptr = Ptr<INeedMoveOnlyArgs>;
-//
-//  Ptr ptr = boost::make_shared<INeedMoveOnlyArgs>();
-//  const int value = 122334958946;
-//  std::unique_ptr<int> ptrValue{ new int(value) };
-//
-//  auto ftArgs = safeMemberAsync<void, INeedMoveOnlyArgs>([](Ptr& ptr, std::unique_ptr<int> value) mutable {
-//    return ptr->setValue(std::move(value));
-//  }, ptr, std::move(ptrValue));
-//  EXPECT_TRUE(test::finishesWithValue(ftArgs));
-//  ASSERT_TRUE(ptr->value);
-//  EXPECT_EQ(value, *ptr->value);
-//}
+namespace {
+  struct INeedMoveOnlyArgs
+  {
+    std::unique_ptr<int> value;
+
+    void setValue(std::unique_ptr<int> newValue)
+    {
+      value = std::move(newValue);
+    }
+  };
+}
+
+TEST(QiLangCommon, safeMemberAsyncAllowsMoveOnlyArgs)
+{
+  using qilang::detail::safeMemberAsync;
+  using Ptr = Ptr<INeedMoveOnlyArgs>;
+
+  Ptr ptr = boost::make_shared<INeedMoveOnlyArgs>();
+  const int value = 1223349589;
+  std::unique_ptr<int> ptrValue{ new int(value) };
+
+  auto ftArgs = safeMemberAsync<void, INeedMoveOnlyArgs>([](Ptr& ptr, std::unique_ptr<int> value) mutable {
+    return ptr->setValue(std::move(value));
+  }, ptr, std::move(ptrValue));
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, ftArgs.wait(waitTimeout));
+  ASSERT_TRUE(ptr->value);
+  EXPECT_EQ(value, *ptr->value);
+}
+
+namespace {
+  struct CopyCounter
+  {
+    CopyCounter() = default;
+    CopyCounter(const CopyCounter& other) : copies(other.copies + 1) {}
+    CopyCounter(CopyCounter&& other) = default;
+    CopyCounter& operator=(const CopyCounter& other) { copies = other.copies + 1; return *this; }
+    CopyCounter& operator=(CopyCounter&& other) = default;
+
+    int copies = 0;
+  };
+
+  struct ISinkArgs
+  {
+    int received = -1;
 
+    void sink(CopyCounter counter)
+    {
+      received = counter.copies;
+    }
+  };
+}
+
+TEST(QiLangCommon, safeMemberAsyncDoesNotCopyMovedArgs)
+{
+  using qilang::detail::safeMemberAsync;
+  using Ptr = Ptr<ISinkArgs>;
+
+  Ptr ptr = boost::make_shared<ISinkArgs>();
+  CopyCounter counter;
+
+  auto ft = safeMemberAsync<void, ISinkArgs>([](Ptr& ptr, CopyCounter counter) mutable {
+    return ptr->sink(std::move(counter));
+  }, ptr, std::move(counter));
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, ft.wait(waitTimeout));
+  EXPECT_EQ(0, ptr->received);
+}
+
+namespace {
+  struct LazilyRegistered {};
+  struct NeverRegistered {};
+
+  int lazyRegistrationCount = 0;
+  void registerLazily() { ++lazyRegistrationCount; }
+}
+
+TEST(QiLangCommon, typeRegistryRunsDeferredRegistrationOnce)
+{
+  using qilang::detail::TypeRegistry;
+
+  EXPECT_TRUE(TypeRegistry::defer(typeid(LazilyRegistered), &registerLazily));
+  EXPECT_EQ(0, lazyRegistrationCount);
+
+  TypeRegistry::ensureRegistered(typeid(LazilyRegistered));
+  EXPECT_EQ(1, lazyRegistrationCount);
+
+  TypeRegistry::ensureRegistered(typeid(LazilyRegistered));
+  EXPECT_EQ(1, lazyRegistrationCount);
+
+  // Types without a deferred registration are ignored.
+  TypeRegistry::ensureRegistered(typeid(NeverRegistered));
+  EXPECT_EQ(1, lazyRegistrationCount);
+}
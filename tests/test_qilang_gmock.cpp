@@ -1,6 +1,7 @@
 #include <future>
 #include <gmock/gmock.h>
 #include <boost/make_shared.hpp>
+#include <qi/anymodule.hpp>
 #include <testqilang/gmock/somemix.hpp>
 #include "test_qilang.hpp"
 
@@ -21,6 +22,25 @@ TEST(QiLangGMock, typeErasedCallToMockedFunction)
   ASSERT_EQ(truth, kindaManager.call<int>("findTruth"));
 }
 
+TEST(QiLangGMock, typeErasedMockInFreshProcess)
+{
+  // Runs in a new process, where no object implementing the interface was created yet.
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  EXPECT_EXIT(
+    {
+      // The module defers the registration of the interface.
+      qi::import("testqilang_module");
+      if (qi::getType(typeid(testqilang::KindaManager)))
+        std::exit(1);
+      auto kindaManagerMock = boost::make_shared<testqilang::gmock::KindaManagerGMock>();
+      qi::AnyObject kindaManager{kindaManagerMock};
+      if (kindaManager.metaObject().findMethod("findTruth").empty())
+        std::exit(2);
+      std::exit(qi::getType(typeid(testqilang::KindaManager)) ? 0 : 3);
+    },
+    ::testing::ExitedWithCode(0), "");
+}
+
 TEST(QiLangGMock, typeErasedCallToNiceMockedFunction)
 {
   int truth = 1337;
@@ -0,0 +1,128 @@
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/future.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/instrument.hpp>
+#include <testqilang/instrumented.hpp>
+
+namespace
+{
+  std::uint64_t finishedCalls(const qilang::detail::MethodStatsSnapshot& stats)
+  {
+    return std::accumulate(stats.latencies.begin(), stats.latencies.end(), std::uint64_t{ 0 });
+  }
+}
+
+TEST(Instrument, latenciesAreBucketedByPowersOfTwo)
+{
+  using qilang::detail::methodLatencyBucket;
+  EXPECT_EQ(0u, methodLatencyBucket(qi::NanoSeconds{ 500 }));
+  EXPECT_EQ(1u, methodLatencyBucket(qi::MicroSeconds{ 1 }));
+  EXPECT_EQ(2u, methodLatencyBucket(qi::MicroSeconds{ 3 }));
+  EXPECT_EQ(3u, methodLatencyBucket(qi::MicroSeconds{ 4 }));
+  EXPECT_EQ(qilang::detail::methodLatencyBucketCount - 1, methodLatencyBucket(qi::Hours{ 1000 }));
+}
+
+TEST(Instrument, callIsCountedOnceFinished)
+{
+  auto table = std::make_shared<qilang::detail::MethodStatsTable>(2);
+  qi::Promise<int> promise;
+  qi::Future<int> result = qilang::detail::trackCall(table, 1, [&] { return promise.future(); });
+
+  auto stats = table->at(1).snapshot();
+  EXPECT_EQ(1u, stats.calls);
+  EXPECT_EQ(1u, stats.inFlight);
+  EXPECT_EQ(0u, finishedCalls(stats));
+  EXPECT_EQ(0u, table->at(0).snapshot().calls);
+
+  promise.setValue(42);
+  EXPECT_EQ(42, result.value());
+  stats = table->at(1).snapshot();
+  EXPECT_EQ(1u, stats.calls);
+  EXPECT_EQ(0u, stats.inFlight);
+  EXPECT_EQ(0u, stats.errors);
+  EXPECT_EQ(1u, finishedCalls(stats));
+}
+
+TEST(Instrument, failedCallsAreCounted)
+{
+  auto table = std::make_shared<qilang::detail::MethodStatsTable>(1);
+  qi::Promise<int> promise;
+  qilang::detail::trackCall(table, 0, [&] { return promise.future(); });
+  promise.setError("failed");
+  EXPECT_THROW(qilang::detail::trackCall(table, 0, []() -> qi::Future<int> { throw std::runtime_error("failed"); }),
+               std::runtime_error);
+
+  const auto stats = table->at(0).snapshot();
+  EXPECT_EQ(2u, stats.calls);
+  EXPECT_EQ(2u, stats.errors);
+  EXPECT_EQ(0u, stats.inFlight);
+}
+
+TEST(Instrument, resetKeepsTheCallsInFlight)
+{
+  auto table = std::make_shared<qilang::detail::MethodStatsTable>(1);
+  qilang::detail::trackCall(table, 0, [] { return qi::Future<int>{ 1 }; });
+  qi::Promise<int> promise;
+  qilang::detail::trackCall(table, 0, [&] { return promise.future(); });
+
+  table->reset();
+  auto stats = table->at(0).snapshot();
+  EXPECT_EQ(0u, stats.calls);
+  EXPECT_EQ(1u, stats.inFlight);
+  EXPECT_EQ(0u, finishedCalls(stats));
+
+  promise.setValue(2);
+  stats = table->at(0).snapshot();
+  EXPECT_EQ(0u, stats.inFlight);
+  EXPECT_EQ(1u, finishedCalls(stats));
+}
+
+TEST(Instrument, generatedBindingCountsTheCallsOfEachMethod)
+{
+  auto module = qi::import("testqilang_module");
+  testqilang::GaugePtr gauge = module.call<qi::AnyObject>("Gauge");
+
+  EXPECT_EQ(42, gauge->findTruth());
+  EXPECT_EQ(42, gauge->async().findTruth().value());
+  gauge->overlord(3);
+  gauge->overlord(std::string("one"));
+  EXPECT_EQ(1, gauge->overlord1());
+
+  auto stats = gauge->gaugeStats();
+  EXPECT_EQ(2u, stats.findTruth.calls);
+  EXPECT_EQ(2u, finishedCalls(stats.findTruth));
+  EXPECT_EQ(0u, stats.overlord.calls);
+  EXPECT_EQ(1u, stats.overlord2.calls);
+  // the counters of the second overload do not take the name of the method `overlord1`
+  EXPECT_EQ(1u, stats.overlord1_.calls);
+  EXPECT_EQ(1u, stats.overlord1.calls);
+
+  // the async binding has them too
+  EXPECT_EQ(2u, gauge->async().gaugeStats().findTruth.calls);
+  gauge->async().resetGaugeStats();
+  EXPECT_EQ(0u, gauge->gaugeStats().findTruth.calls);
+}
+
+TEST(Instrument, generatedProxyAndServiceCountTheCalls)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  testqilang::GaugePtr service = module.call<qi::AnyObject>("Gauge");
+  p.server()->registerService("Gauge", service);
+  testqilang::GaugePtr gauge = p.client()->service("Gauge").value();
+
+  EXPECT_EQ(42, gauge->findTruth());
+  EXPECT_EQ(9, gauge->async().square(3).value());
+
+  const auto stats = gauge->gaugeStats();
+  EXPECT_EQ(1u, stats.findTruth.calls);
+  EXPECT_EQ(1u, stats.square.calls);
+  EXPECT_EQ(0u, stats.findTruth.errors);
+  EXPECT_EQ(1u, service->gaugeStats().findTruth.calls);
+}
@@ -0,0 +1,42 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/future.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/probe.hpp>
+#include <testqilang/instrumented.hpp>
+
+TEST(Probe, argumentsAreSizedByTheirContent)
+{
+  using qilang::detail::probeArgumentsSize;
+  EXPECT_EQ(0u, probeArgumentsSize());
+  EXPECT_EQ(3u, probeArgumentsSize(std::string("abc")));
+  EXPECT_EQ(2 * sizeof(int), probeArgumentsSize(std::vector<int>{ 1, 2 }));
+  EXPECT_EQ(3 + sizeof(double), probeArgumentsSize(std::string("abc"), 1.5));
+}
+
+TEST(Probe, probedCallIsUnchanged)
+{
+  qi::Promise<int> promise;
+  qi::Future<int> result = qilang::detail::probeCall("Probed", "call", 0, [&] { return promise.future(); });
+  promise.setValue(42);
+  EXPECT_EQ(42, result.value());
+  EXPECT_THROW(qilang::detail::probeCall("Probed", "call", 0, []() -> qi::Future<int> {
+                 throw std::runtime_error("failed");
+               }), std::runtime_error);
+}
+
+TEST(Probe, generatedProxyAndServiceAreProbed)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  testqilang::GaugePtr service = module.call<qi::AnyObject>("Gauge");
+  p.server()->registerService("Gauge", service);
+  testqilang::GaugePtr gauge = p.client()->service("Gauge").value();
+
+  EXPECT_EQ(42, gauge->findTruth());
+  EXPECT_EQ(2, gauge->collect(std::vector<testqilang::Error>(2)));
+}
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
+#include <atomic>
 #include <future>
+#include <thread>
+#include <qi/clock.hpp>
+#include <testsession/testsession.hpp>
 #include <testqilang/someproperties.hpp>
 #include <boost/optional/optional_io.hpp>
 #include "test_qilang.hpp"
@@ -33,3 +37,59 @@ TEST_F(QiLangProperty, connectOptional)
   ASSERT_EQ(expected, receivedFuture.get());
   ASSERT_EQ(expected, propertyMaster->optionalProperty.get().value().get());
 }
+
+TEST_F(QiLangProperty, remoteProxyReadsItsCopy)
+{
+  TestSessionPair p;
+  auto service = _testqilang.call<qi::AnyObject>("PropertyMaster");
+  p.server()->registerService("PropertyMaster", service);
+  qi::Object<PropertyMaster> propertyMaster = p.client()->service("PropertyMaster").value();
+
+  // the copy is updated by the change notifications, which are asynchronous
+  service.setProperty("intProperty", 12).value();
+  const auto deadline = qi::SteadyClock::now() + qi::Seconds{ 5 };
+  while (propertyMaster->intProperty.get().value() != 12 && qi::SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(usualTimeout / 10);
+  ASSERT_EQ(12, propertyMaster->intProperty.get().value());
+
+  // written through, and read back right away
+  propertyMaster->intProperty.set(13).value();
+  EXPECT_EQ(13, propertyMaster->intProperty.get().value());
+  EXPECT_EQ(13, service.property<int>("intProperty").value());
+}
+
+TEST_F(QiLangProperty, uncachedPropertyIsReadFromTheService)
+{
+  TestSessionPair p;
+  auto service = _testqilang.call<qi::AnyObject>("PropertyMaster");
+  p.server()->registerService("PropertyMaster", service);
+  qi::Object<PropertyMaster> propertyMaster = p.client()->service("PropertyMaster").value();
+
+  service.setProperty("strictProperty", 7).value();
+  EXPECT_EQ(7, propertyMaster->strictProperty.get().value());
+}
+
+TEST_F(QiLangProperty, remoteProxySubscribesOnFirstLocalConnect)
+{
+  TestSessionPair p;
+  auto service = _testqilang.call<qi::AnyObject>("PropertyMaster");
+  p.server()->registerService("PropertyMaster", service);
+  qi::Object<PropertyMaster> propertyMaster = p.client()->service("PropertyMaster").value();
+
+  // never read: the copy is only subscribed to the changes by the local subscriber
+  std::promise<int> received;
+  std::atomic<bool> notified{ false };
+  propertyMaster->intProperty.connect([&received, &notified](int value) {
+    if (value == 21 && !notified.exchange(true))
+      received.set_value(value);
+  }).value();
+  // the subscription to the service is asynchronous: changes are made until one is notified
+  const auto deadline = qi::SteadyClock::now() + qi::Seconds{ 5 };
+  auto receivedFuture = received.get_future();
+  do
+    service.setProperty("intProperty", 21).value();
+  while (receivedFuture.wait_for(usualTimeout / 10) != std::future_status::ready && qi::SteadyClock::now() < deadline);
+  ASSERT_EQ(std::future_status::ready, receivedFuture.wait_for(std::chrono::seconds(0)));
+  EXPECT_EQ(21, receivedFuture.get());
+  EXPECT_EQ(21, propertyMaster->intProperty.get().value());
+}
@@ -39,3 +39,35 @@ TEST_F(QiLangRaw, usingStruct)
   ASSERT_EQ(vampire.data, deadVampire.data);
   ASSERT_EQ(vampire.annotation, deadVampire.annotation);
 }
+
+TEST_F(QiLangRaw, viewIdentityMethod)
+{
+  static const std::string data = "cogito ergo sum";
+  const qilang::SharedBuffer view(data.data(), data.size());
+  const auto result = _buffy->viewIdentity(view);
+  ASSERT_EQ(view, result);
+  ASSERT_EQ(data.size(), result.size());
+}
+
+TEST_F(QiLangRaw, viewIsWireCompatibleWithBuffer)
+{
+  static const std::string data = "sum ergo cogito";
+  const qilang::SharedBuffer view(data.data(), data.size());
+  ASSERT_EQ(qi::typeOf<qi::Buffer>()->signature(), qi::typeOf<qilang::SharedBuffer>()->signature());
+  ASSERT_EQ(view.buffer(), _buffy->viewAsBuffer(view));
+
+  // A buffer can be received where a view is expected and vice versa.
+  qi::AnyObject obj = _buffy;
+  ASSERT_EQ(view.buffer(), obj.call<qi::Buffer>("viewIdentity", view.buffer()));
+  ASSERT_EQ(view, obj.call<qilang::SharedBuffer>("bufferIdentity", view));
+}
+
+TEST(QiLangSharedBuffer, copyDoesNotCopyThePayload)
+{
+  static const std::string data = "nothing to see here";
+  const qilang::SharedBuffer view(data.data(), data.size());
+  const qilang::SharedBuffer copy = view;
+  ASSERT_EQ(view.data(), copy.data());
+  ASSERT_EQ(2, view.useCount());
+  ASSERT_TRUE(qilang::SharedBuffer().empty());
+}
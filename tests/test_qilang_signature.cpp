@@ -39,6 +39,16 @@ TEST(TestSignature, signatureToQiLangOpt) {
   EXPECT_STREQ("(+bool, +int8, +uint8, +int16, +uint16, +int32, +uint32, +int64, +uint64, +float32, +float64, +str, +any)", qilang::format(node).c_str());
 }
 
+TEST(TestSignature, qiLangArrayToSignature) {
+  qilang::TypeExprNodePtr element = boost::make_shared<qilang::BuiltinTypeExprNode>(qilang::BuiltinType_Float64, "float64", qilang::Location());
+  qilang::TypeExprNodePtr array = boost::make_shared<qilang::ArrayTypeExprNode>(element, 3, qilang::Location());
+  std::string signature;
+
+  EXPECT_TRUE(qilang::qiLangToSignature(array, signature));
+  EXPECT_EQ("(ddd)", signature);
+  EXPECT_STREQ("[3]float64", qilang::format(array).c_str());
+}
+
 qi::MetaMethod metaMethodeTest(){
   const qi::Signature returnSignature("i");
   const qi::Signature parametersSignature("(bcCiIlLfdsm)");
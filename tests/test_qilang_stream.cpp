@@ -0,0 +1,171 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/stream.hpp>
+#include <testqilang/somemix.hpp>
+
+namespace
+{
+  const auto waitTimeout = qi::Seconds{ 5 };
+
+  // Reads the stream to its end.
+  template <typename T>
+  std::vector<T> readAll(qilang::StreamReader<T>& reader)
+  {
+    std::vector<T> values;
+    while (true)
+    {
+      auto chunk = reader.read();
+      EXPECT_EQ(qi::FutureState_FinishedWithValue, chunk.wait(waitTimeout)) << chunk.error();
+      if (chunk.value().empty())
+        return values;
+      values.insert(values.end(), chunk.value().begin(), chunk.value().end());
+    }
+  }
+
+  // Writes the next number once the previous one is buffered.
+  void produce(qilang::StreamWriter<int> writer, int next, int count)
+  {
+    if (next == count)
+    {
+      writer.close();
+      return;
+    }
+    writer.write(next).then([=](qi::Future<void> written) {
+      if (!written.hasError())
+        produce(writer, next + 1, count);
+    });
+  }
+
+  class StreamProvider
+  {
+  public:
+    qi::AnyObject numbers(int count)
+    {
+      qilang::StreamWriter<int> writer(2);
+      produce(writer, 0, count);
+      return writer.stream();
+    }
+  };
+}
+QI_REGISTER_OBJECT(StreamProvider, numbers);
+
+TEST(Stream, writesAreBoundedByTheCapacity)
+{
+  qilang::StreamWriter<int> writer(2);
+  qilang::StreamReader<int> reader(writer.stream(), 10);
+
+  EXPECT_TRUE(writer.write(1).isFinished());
+  EXPECT_TRUE(writer.write(2).isFinished());
+  auto blocked = writer.write(3);
+  EXPECT_FALSE(blocked.isFinished());
+
+  auto chunk = reader.read();
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, chunk.wait(waitTimeout));
+  EXPECT_EQ((std::vector<int>{ 1, 2 }), chunk.value());
+  EXPECT_EQ(qi::FutureState_FinishedWithValue, blocked.wait(waitTimeout));
+
+  writer.close();
+  EXPECT_EQ(std::vector<int>{ 3 }, readAll(reader));
+}
+
+TEST(Stream, readWaitsForTheWriter)
+{
+  qilang::StreamWriter<std::string> writer;
+  qilang::StreamReader<std::string> reader(writer.stream());
+
+  auto chunk = reader.read();
+  EXPECT_FALSE(chunk.isFinished());
+  writer.write("hello");
+  ASSERT_EQ(qi::FutureState_FinishedWithValue, chunk.wait(waitTimeout));
+  EXPECT_EQ(std::vector<std::string>{ "hello" }, chunk.value());
+}
+
+TEST(Stream, failureIsReportedToTheReader)
+{
+  qilang::StreamWriter<int> writer;
+  qilang::StreamReader<int> reader(writer.stream());
+
+  writer.write(1);
+  writer.fail("disk full");
+  EXPECT_EQ(std::vector<int>{ 1 }, reader.read().value());
+  auto chunk = reader.read();
+  ASSERT_EQ(qi::FutureState_FinishedWithError, chunk.wait(waitTimeout));
+  EXPECT_EQ("disk full", chunk.error());
+}
+
+TEST(Stream, droppedWriterFailsTheStream)
+{
+  qilang::Stream<int> stream;
+  qi::Future<std::vector<int>> chunk;
+  {
+    qilang::StreamWriter<int> writer;
+    qilang::StreamWriter<int> copy = writer;
+    stream = writer.stream();
+    chunk = qilang::StreamReader<int>(stream).read();
+    copy.write(1);
+    writer.write(2);
+  }
+  EXPECT_EQ(std::vector<int>{ 1 }, chunk.value());
+  qilang::StreamReader<int> reader(stream);
+  EXPECT_EQ(std::vector<int>{ 2 }, reader.read().value());
+  chunk = reader.read();
+  ASSERT_EQ(qi::FutureState_FinishedWithError, chunk.wait(waitTimeout));
+  EXPECT_EQ("the stream writer was destroyed", chunk.error());
+
+  // a closed stream stays closed
+  {
+    qilang::StreamWriter<int> writer;
+    stream = writer.stream();
+    writer.close();
+  }
+  EXPECT_TRUE(qilang::StreamReader<int>(stream).read().value().empty());
+}
+
+TEST(Stream, cancelStopsTheWriter)
+{
+  qilang::StreamWriter<int> writer(1);
+  qilang::StreamReader<int> reader(writer.stream());
+
+  writer.write(1);
+  auto blocked = writer.write(2);
+  reader.cancel().wait(waitTimeout);
+  EXPECT_EQ(qi::FutureState_FinishedWithError, blocked.wait(waitTimeout));
+  EXPECT_TRUE(writer.write(3).hasError());
+}
+
+TEST(Stream, readerChecksTheTypeOfTheValues)
+{
+  qilang::StreamWriter<int> writer;
+  EXPECT_THROW(qilang::StreamReader<std::string>(writer.stream()), std::runtime_error);
+  EXPECT_NO_THROW(qilang::StreamReader<int>(writer.stream()));
+  writer.close();
+}
+
+TEST(Stream, remoteReaderPullsChunks)
+{
+  TestSessionPair p;
+  p.server()->registerService("StreamProvider", boost::make_shared<StreamProvider>());
+  qi::AnyObject provider = p.client()->service("StreamProvider").value();
+
+  qilang::StreamReader<int> reader(provider.call<qi::AnyObject>("numbers", 5), 2);
+  EXPECT_EQ((std::vector<int>{ 0, 1, 2, 3, 4 }), readAll(reader));
+  // the type of the values is checked against the remote stream too
+  EXPECT_THROW(qilang::StreamReader<std::string>(provider.call<qi::AnyObject>("numbers", 0)), std::runtime_error);
+}
+
+TEST(Stream, generatedMethodReturnsAStream)
+{
+  auto module = qi::import("testqilang_module");
+  auto km = module.call<testqilang::KindaManagerPtr>("KindaManager");
+
+  qilang::StreamReader<std::string> reader(km->exportLog(10), 3);
+  const std::vector<std::string> lines = readAll(reader);
+  ASSERT_EQ(10u, lines.size());
+  EXPECT_EQ("line 0", lines.front());
+  EXPECT_EQ("line 9", lines.back());
+}
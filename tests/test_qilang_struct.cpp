@@ -1,7 +1,12 @@
 #include <gtest/gtest.h>
 #include <testsession/testsessionpair.hpp>
 #include <testqilang/somestructs.hpp>
+#include <testqilang/telemetry.hpp>
+#include <qi/binarycodec.hpp>
 #include <boost/optional/optional_io.hpp>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 TEST(Struct, defaultConstruction)
 {
@@ -88,3 +93,230 @@ TEST(Struct, remoteCallArgumentConversion)
   ASSERT_EQ(config3From1.n, config3.n);
   ASSERT_EQ(config3From1.name, config3.name);
 }
+
+namespace
+{
+  struct MacroPosition
+  {
+    double x, y, z;
+  };
+
+  testqilang::Telemetry makeTelemetry()
+  {
+    testqilang::Telemetry telemetry;
+    telemetry.timestamp = 1234567890123;
+    telemetry.position = testqilang::Position{ 1.5, -2.5, 3.25 };
+    telemetry.battery = 0.75f;
+    telemetry.status = 3;
+    telemetry.label = "left arm";
+    telemetry.samples = { 0.5f, 1.5f, 2.5f };
+    return telemetry;
+  }
+}
+QI_TYPE_STRUCT(MacroPosition, x, y, z)
+
+// Check the type interface generated with qicc --specialized-structs
+TEST(Struct, specializedTypeDescribesFields)
+{
+  auto type = dynamic_cast<qi::StructTypeInterface*>(qi::typeOf<testqilang::Telemetry>());
+  ASSERT_NE(nullptr, type);
+  const std::vector<std::string> names{ "timestamp", "position", "battery", "status", "label", "samples" };
+  EXPECT_EQ(names, type->elementsName());
+  EXPECT_EQ("testqilang::Telemetry", type->className());
+  const auto memberTypes = type->memberTypes();
+  ASSERT_EQ(names.size(), memberTypes.size());
+  EXPECT_EQ(qi::typeOf<qi::int64_t>()->info(), memberTypes.at(0)->info());
+  EXPECT_EQ(qi::typeOf<testqilang::Position>()->info(), memberTypes.at(1)->info());
+  EXPECT_EQ(qi::typeOf<std::vector<float>>()->info(), memberTypes.at(5)->info());
+}
+
+TEST(Struct, specializedTypeRoundTripsThroughBinaryCodec)
+{
+  const auto telemetry = makeTelemetry();
+  qi::Buffer buffer;
+  qi::encodeBinary(&buffer, qi::AutoAnyReference(telemetry));
+
+  testqilang::Telemetry decoded;
+  qi::BufferReader reader(buffer);
+  qi::decodeBinary(&reader, &decoded);
+  EXPECT_EQ(telemetry.timestamp, decoded.timestamp);
+  EXPECT_EQ(telemetry.position.x, decoded.position.x);
+  EXPECT_EQ(telemetry.position.y, decoded.position.y);
+  EXPECT_EQ(telemetry.position.z, decoded.position.z);
+  EXPECT_EQ(telemetry.battery, decoded.battery);
+  EXPECT_EQ(telemetry.status, decoded.status);
+  EXPECT_EQ(telemetry.label, decoded.label);
+  EXPECT_EQ(telemetry.samples, decoded.samples);
+}
+
+TEST(Struct, specializedTypeConvertsToMacroRegisteredStruct)
+{
+  const testqilang::Position position{ 1.5, -2.5, 3.25 };
+  const auto converted = qi::AnyReference::from(position).to<MacroPosition>();
+  EXPECT_EQ(position.x, converted.x);
+  EXPECT_EQ(position.y, converted.y);
+  EXPECT_EQ(position.z, converted.z);
+
+  const auto back = qi::AnyReference::from(converted).to<testqilang::Position>();
+  EXPECT_EQ(position.x, back.x);
+  EXPECT_EQ(position.y, back.y);
+  EXPECT_EQ(position.z, back.z);
+}
+
+TEST(Struct, specializedEmptyStructRoundTripsThroughBinaryCodec)
+{
+  const testqilang::Heartbeat heartbeat;
+  qi::Buffer buffer;
+  qi::encodeBinary(&buffer, qi::AutoAnyReference(heartbeat));
+
+  testqilang::Heartbeat decoded;
+  qi::BufferReader reader(buffer);
+  qi::decodeBinary(&reader, &decoded);
+  auto type = dynamic_cast<qi::StructTypeInterface*>(qi::typeOf<testqilang::Heartbeat>());
+  ASSERT_NE(nullptr, type);
+  EXPECT_TRUE(type->elementsName().empty());
+}
+
+// Check the members reordered by qicc --reorder-struct-fields
+TEST(Struct, reorderedMembersMinimizePadding)
+{
+  // declared order: bool, float64, int8, int32
+  EXPECT_EQ(2 * sizeof(double), sizeof(testqilang::Sample));
+}
+
+TEST(Struct, reorderedMembersFollowTheLayoutOfPairs)
+{
+  // declared order: bool, Tuple<int8, float64> (std::pair, 16 bytes), int32
+  EXPECT_EQ(sizeof(std::pair<std::int8_t, double>), 2 * sizeof(double));
+  EXPECT_EQ(3 * sizeof(double), sizeof(testqilang::Interval));
+}
+
+TEST(Struct, reorderedMembersKeepDeclaredOrderOnTheWire)
+{
+  auto type = dynamic_cast<qi::StructTypeInterface*>(qi::typeOf<testqilang::Sample>());
+  ASSERT_NE(nullptr, type);
+  const std::vector<std::string> names{ "valid", "value", "flags", "count" };
+  EXPECT_EQ(names, type->elementsName());
+  EXPECT_EQ(0u, type->signature().toString().find("(bdci)"));
+
+  testqilang::Sample sample;
+  sample.valid = true;
+  sample.value = 2.5;
+  sample.flags = 3;
+  sample.count = 42;
+  qi::Buffer buffer;
+  qi::encodeBinary(&buffer, qi::AutoAnyReference(sample));
+
+  const auto tuple = qi::AnyReference::from(sample).to<std::tuple<bool, double, qi::int8_t, int>>();
+  EXPECT_EQ(std::make_tuple(true, 2.5, qi::int8_t(3), 42), tuple);
+
+  testqilang::Sample decoded;
+  qi::BufferReader reader(buffer);
+  qi::decodeBinary(&reader, &decoded);
+  EXPECT_EQ(sample.valid, decoded.valid);
+  EXPECT_EQ(sample.value, decoded.value);
+  EXPECT_EQ(sample.flags, decoded.flags);
+  EXPECT_EQ(sample.count, decoded.count);
+}
+
+namespace
+{
+  std::vector<testqilang::CloudPoint> makeCloud()
+  {
+    std::vector<testqilang::CloudPoint> cloud;
+    for (int i = 0; i < 5; ++i)
+    {
+      testqilang::CloudPoint point;
+      point.x = float(i);
+      point.y = float(2 * i);
+      point.z = float(-i);
+      point.intensity = static_cast<qi::uint8_t>(10 * i);
+      cloud.push_back(point);
+    }
+    return cloud;
+  }
+
+  void expectSameCloud(const std::vector<testqilang::CloudPoint>& expected,
+                       const std::vector<testqilang::CloudPoint>& actual)
+  {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (std::size_t i = 0; i < expected.size(); ++i)
+    {
+      EXPECT_EQ(expected[i].x, actual[i].x);
+      EXPECT_EQ(expected[i].y, actual[i].y);
+      EXPECT_EQ(expected[i].z, actual[i].z);
+      EXPECT_EQ(expected[i].intensity, actual[i].intensity);
+    }
+  }
+}
+
+class CloudProvider {
+public:
+  testqilang::CloudPointColumns cloud() {
+    return testqilang::toColumns(makeCloud());
+  }
+};
+QI_REGISTER_OBJECT(CloudProvider, cloud);
+
+// Check the structure-of-arrays companion of a @columns struct
+TEST(Struct, columnsHaveOneVectorPerField)
+{
+  const auto cloud = makeCloud();
+  const auto columns = testqilang::toColumns(cloud);
+  ASSERT_EQ(cloud.size(), columns.x.size());
+  ASSERT_EQ(cloud.size(), columns.y.size());
+  ASSERT_EQ(cloud.size(), columns.z.size());
+  ASSERT_EQ(cloud.size(), columns.intensity.size());
+  EXPECT_EQ(cloud[3].y, columns.y[3]);
+  EXPECT_EQ(cloud[4].intensity, columns.intensity[4]);
+}
+
+TEST(Struct, columnsConvertBackToRows)
+{
+  const auto cloud = makeCloud();
+  expectSameCloud(cloud, testqilang::toRows(testqilang::toColumns(cloud)));
+  EXPECT_TRUE(testqilang::toRows(testqilang::CloudPointColumns{}).empty());
+}
+
+TEST(Struct, columnsOfDifferentSizesDoNotConvertToRows)
+{
+  auto columns = testqilang::toColumns(makeCloud());
+  columns.intensity.pop_back();
+  EXPECT_THROW(testqilang::toRows(columns), std::length_error);
+}
+
+TEST(Struct, columnsCrossProcessBoundaries)
+{
+  TestSessionPair p;
+  p.server()->registerService("CloudProvider", boost::make_shared<CloudProvider>());
+  auto cloudProvider = p.client()->service("CloudProvider");
+  auto columns = cloudProvider.value().call<testqilang::CloudPointColumns>("cloud");
+  expectSameCloud(makeCloud(), testqilang::toRows(columns));
+}
+
+// Check the Array<T, N> fields
+TEST(Struct, arrayFieldsAreStoredInline)
+{
+  static_assert(std::is_same<std::array<double, 3>, decltype(testqilang::Transform::translation)>::value, "");
+  static_assert(std::is_trivially_copyable<testqilang::Transform>::value, "");
+  EXPECT_EQ(3 * sizeof(double) + 16 * sizeof(float), sizeof(testqilang::Transform));
+}
+
+TEST(Struct, arrayFieldsRoundTripThroughBinaryCodec)
+{
+  testqilang::Transform transform{};
+  transform.translation = { 1.5, -2.5, 3.25 };
+  for (std::size_t i = 0; i < 4; ++i)
+    transform.matrix[i][i] = 1.f;
+  transform.matrix[0][3] = 0.5f;
+
+  EXPECT_EQ("(ddd)", qi::typeOf<std::array<double, 3>>()->signature().toString());
+  qi::Buffer buffer;
+  qi::encodeBinary(&buffer, qi::AutoAnyReference(transform));
+
+  testqilang::Transform decoded{};
+  qi::BufferReader reader(buffer);
+  qi::decodeBinary(&reader, &decoded);
+  EXPECT_EQ(transform.translation, decoded.translation);
+  EXPECT_EQ(transform.matrix, decoded.matrix);
+}
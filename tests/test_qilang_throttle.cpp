@@ -0,0 +1,129 @@
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/clock.hpp>
+#include <qilang/throttle.hpp>
+#include <qilang/parser.hpp>
+#include <testqilang/somemix.hpp>
+
+namespace
+{
+  const auto waitTimeout = qi::Seconds{ 5 };
+
+  bool parseFails(const std::string& members)
+  {
+    std::istringstream in("package testthrottle\ninterface Throttled\n" + members + "\nend\n");
+    return qilang::parse(qilang::newFileReader(&in, "throttle.idl.qi"))->hasError();
+  }
+
+  // Values received by a subscriber, which is called asynchronously.
+  template<typename T>
+  class Received
+  {
+  public:
+    void operator()(const T& value)
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _values.push_back(value);
+    }
+
+    // The values received, once there are `count` of them or the timeout is over.
+    std::vector<T> waitFor(std::size_t count)
+    {
+      const auto deadline = qi::SteadyClock::now() + waitTimeout;
+      while (values().size() < count && qi::SteadyClock::now() < deadline)
+        std::this_thread::sleep_for(qi::MilliSeconds{ 5 });
+      return values();
+    }
+
+    std::vector<T> values()
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _values;
+    }
+
+  private:
+    std::mutex _mutex;
+    std::vector<T> _values;
+  };
+}
+
+TEST(Throttle, annotationsAreChecked)
+{
+  EXPECT_FALSE(parseFails("@coalesce(50) sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@coalesce sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@coalesce(0) sig s(x: int)"));
+  EXPECT_TRUE(parseFails("@coalesce(50) prop p(x: int)"));
+  EXPECT_TRUE(parseFails("@coalesce(50) fn f(x: int)"));
+  EXPECT_FALSE(parseFails("@deadband(0.5) prop p(x: float)"));
+  EXPECT_FALSE(parseFails("@deadband(2) prop p(x: int)"));
+  EXPECT_TRUE(parseFails("@deadband prop p(x: int)"));
+  EXPECT_TRUE(parseFails("@deadband(-1) prop p(x: int)"));
+  EXPECT_TRUE(parseFails("@deadband(0.5) prop p(x: str)"));
+  EXPECT_TRUE(parseFails("@deadband(0.5) sig s(x: float)"));
+}
+
+TEST(Throttle, firstEmissionIsRelayedRightAway)
+{
+  qi::Signal<int> source;
+  qi::Signal<int> target;
+  Received<int> received;
+  target.connect([&](int value) { received(value); });
+  qilang::detail::SignalCoalescer<int> coalescer(source, target, qi::MilliSeconds{ 60000 });
+
+  QI_EMIT source(1);
+  EXPECT_EQ(std::vector<int>{ 1 }, received.waitFor(1));
+}
+
+TEST(Throttle, latestEmissionIsRelayedAtTheEndOfThePeriod)
+{
+  qi::Signal<int, std::string> source;
+  qi::Signal<int, std::string> target;
+  Received<int> received;
+  target.connect([&](int value, const std::string&) { received(value); });
+  qilang::detail::SignalCoalescer<int, std::string> coalescer(source, target, qi::MilliSeconds{ 100 });
+
+  QI_EMIT source(1, "a");
+  received.waitFor(1);
+  QI_EMIT source(2, "b");
+  QI_EMIT source(3, "c");
+  EXPECT_EQ((std::vector<int>{ 1, 3 }), received.waitFor(2));
+  std::this_thread::sleep_for(qi::MilliSeconds{ 200 });
+  EXPECT_EQ(2u, received.values().size());
+}
+
+TEST(Throttle, smallChangesAreNotRelayed)
+{
+  qi::Property<float> source;
+  qi::Property<float> target;
+  Received<float> received;
+  target.connect([&](float value) { received(value); });
+  qilang::detail::PropertyDeadband<float> deadband(source, target, 0.5);
+
+  source.set(20.f).value();
+  received.waitFor(1);
+  source.set(20.2f).value();
+  source.set(19.6f).value();
+  EXPECT_EQ((std::vector<float>{ 20.f, 19.6f }), received.waitFor(2));
+  EXPECT_FLOAT_EQ(19.6f, deadband.get());
+}
+
+TEST(Throttle, generatedPropertyIsNotifiedPastItsDeadband)
+{
+  auto module = qi::import("testqilang_module");
+  testqilang::KindaManagerPtr km = module.call<qi::AnyObject>("KindaManager");
+  Received<float> received;
+  km->temperature.connect([&](float value) { received(value); });
+
+  km->temperature.set(20.f).value();
+  received.waitFor(1);
+  km->temperature.set(20.2f).value();
+  EXPECT_FLOAT_EQ(20.2f, km->temperature.get().value());
+  km->temperature.set(20.6f).value();
+  EXPECT_EQ((std::vector<float>{ 20.f, 20.6f }), received.waitFor(2));
+}
@@ -0,0 +1,100 @@
+#include <sstream>
+#include <string>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/clock.hpp>
+#include <qi/future.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/deadline.hpp>
+#include <qilang/parser.hpp>
+#include <testqilang/somemix.hpp>
+
+namespace
+{
+  bool parseFails(const std::string& members)
+  {
+    std::istringstream in("package testtimeout\ninterface Timed\n" + members + "\nend\n");
+    return qilang::parse(qilang::newFileReader(&in, "timeout.idl.qi"))->hasError();
+  }
+
+  qi::SteadyClockTimePoint in(qi::MilliSeconds delay)
+  {
+    return qi::SteadyClock::now() + delay;
+  }
+}
+
+TEST(Timeout, annotationsAreChecked)
+{
+  EXPECT_FALSE(parseFails("@timeout(100) fn f(x: int) -> int"));
+  EXPECT_FALSE(parseFails("@timeout(100) fn f()"));
+  EXPECT_FALSE(parseFails("@idempotent @timeout(100) fn f(x: int) -> int"));
+  EXPECT_TRUE(parseFails("@timeout fn f()"));
+  EXPECT_TRUE(parseFails("@timeout(0) fn f()"));
+  EXPECT_TRUE(parseFails("@timeout(-5) fn f()"));
+  EXPECT_TRUE(parseFails("@timeout(100, 200) fn f()"));
+  EXPECT_TRUE(parseFails("@timeout(100) sig s(x: int)"));
+}
+
+TEST(Timeout, overloadsTakingTheDeadlineAreRejected)
+{
+  EXPECT_FALSE(parseFails("@timeout(100) fn f(x: int)\nfn f(x: int, y: int)"));
+  EXPECT_FALSE(parseFails("@timeout(100) fn f(x: int)\nfn f(x: str, d: steadytimepoint)"));
+  EXPECT_TRUE(parseFails("@timeout(100) fn f(x: int)\nfn f(x: int, d: steadytimepoint)"));
+  EXPECT_TRUE(parseFails("fn f(d: steadytimepoint) -> int\n@timeout(100) fn f() -> int"));
+}
+
+TEST(Timeout, callFinishedInTimeIsUnchanged)
+{
+  qi::Promise<int> promise;
+  qi::Future<int> result = qilang::detail::withDeadline(in(qi::MilliSeconds{ 5000 }), [&] { return promise.future(); });
+  promise.setValue(42);
+  EXPECT_EQ(42, result.value());
+  EXPECT_EQ(1, qilang::detail::withDeadline(in(qi::MilliSeconds{ 0 }), [] { return qi::Future<int>{ 1 }; }).value());
+}
+
+TEST(Timeout, callIsFailedAndCanceledAtItsDeadline)
+{
+  qi::Promise<int> promise([](qi::Promise<int>& p) { p.setCanceled(); });
+  qi::Future<int> result = qilang::detail::withDeadline(in(qi::MilliSeconds{ 10 }), [&] { return promise.future(); });
+  ASSERT_TRUE(result.hasError());
+  EXPECT_EQ(qilang::detail::deadlineExceededError, result.error());
+  EXPECT_TRUE(promise.future().isCanceled());
+}
+
+TEST(Timeout, cancelingTheResultCancelsTheCall)
+{
+  qi::Promise<int> promise([](qi::Promise<int>& p) { p.setCanceled(); });
+  qi::Future<int> result = qilang::detail::withDeadline(in(qi::MilliSeconds{ 5000 }), [&] { return promise.future(); });
+  result.cancel();
+  EXPECT_TRUE(result.isCanceled());
+  EXPECT_TRUE(promise.future().isCanceled());
+}
+
+TEST(Timeout, generatedProxyFailsCallsPastTheirDeadline)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  testqilang::KindaManagerPtr service = module.call<qi::AnyObject>("KindaManager");
+  p.server()->registerService("KindaManager", service);
+  testqilang::KindaManagerPtr km = p.client()->service("KindaManager").value();
+
+  // the service answers after 100 ms, past the default deadline of 20 ms
+  EXPECT_ANY_THROW(km->ponder("why"));
+  qi::Future<int> answer = km->async().ponder("why");
+  ASSERT_TRUE(answer.hasError());
+  EXPECT_EQ(qilang::detail::deadlineExceededError, answer.error());
+
+  // a deadline given by the caller replaces the default one
+  EXPECT_EQ(3, km->ponder("why", in(qi::MilliSeconds{ 5000 })));
+  EXPECT_TRUE(km->async().ponder("why", in(qi::MilliSeconds{ 10 })).hasError());
+}
+
+TEST(Timeout, generatedBindingOnlyHasTheDeadlinesGivenByTheCaller)
+{
+  auto module = qi::import("testqilang_module");
+  testqilang::KindaManagerPtr km = module.call<qi::AnyObject>("KindaManager");
+
+  EXPECT_EQ(3, km->ponder("why"));
+  EXPECT_TRUE(km->async().ponder("why", in(qi::MilliSeconds{ 10 })).hasError());
+}
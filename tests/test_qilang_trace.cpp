@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include <qi/anymodule.hpp>
+#include <qi/clock.hpp>
+#include <qi/future.hpp>
+#include <testsession/testsession.hpp>
+#include <qilang/trace.hpp>
+#include <testqilang/instrumented.hpp>
+
+namespace
+{
+  // The events of the calls of `method`, over all threads.
+  std::vector<qilang::detail::TraceEvent> eventsOf(const std::string& method)
+  {
+    std::vector<qilang::detail::TraceEvent> events;
+    for (const auto& ring : qilang::detail::traceRegistry().rings())
+    {
+      for (const auto& event : ring->events())
+      {
+        if (event.method == method)
+          events.push_back(event);
+      }
+    }
+    return events;
+  }
+
+  std::string chromeTrace()
+  {
+    std::ostringstream out;
+    qilang::detail::writeChromeTrace(out);
+    return out.str();
+  }
+}
+
+TEST(Trace, ringKeepsTheLatestEvents)
+{
+  qilang::detail::TraceRing ring;
+  const std::uint64_t count = qilang::detail::TraceRing::capacity + 10;
+  for (std::uint64_t span = 1; span <= count; ++span)
+  {
+    qilang::detail::TraceEvent event;
+    event.span = span;
+    ring.push(event);
+  }
+
+  const auto events = ring.events();
+  ASSERT_EQ(qilang::detail::TraceRing::capacity, events.size());
+  EXPECT_EQ(11u, events.front().span);
+  EXPECT_EQ(count, events.back().span);
+}
+
+TEST(Trace, spansAreUniqueAndNotZero)
+{
+  std::set<std::uint64_t> spans;
+  for (int i = 0; i < 10000; ++i)
+  {
+    const std::uint64_t span = qilang::detail::nextTraceSpan();
+    EXPECT_NE(0u, span);
+    EXPECT_TRUE(spans.insert(span).second);
+  }
+}
+
+TEST(Trace, ringsOfExitedThreadsAreReused)
+{
+  const auto record = [] { qilang::detail::recordTraceEvent("Traced", "threadCall", 'b', 1, 0, false); };
+  std::thread(record).join();
+  const auto rings = qilang::detail::traceRegistry().rings().size();
+  std::thread(record).join();
+  std::thread(record).join();
+  EXPECT_EQ(rings, qilang::detail::traceRegistry().rings().size());
+
+  // the events of the exited threads are kept, with their own thread
+  std::set<std::uint64_t> threads;
+  for (const auto& event : eventsOf("threadCall"))
+    threads.insert(event.thread);
+  EXPECT_EQ(3u, threads.size());
+}
+
+TEST(Trace, callIsRecordedOnceFinished)
+{
+  qi::Promise<int> promise;
+  qilang::detail::traceCall("Traced", "pendingCall", [&] { return promise.future(); });
+  auto events = eventsOf("pendingCall");
+  ASSERT_EQ(1u, events.size());
+  EXPECT_EQ('b', events.at(0).phase);
+
+  promise.setError("failed");
+  events = eventsOf("pendingCall");
+  ASSERT_EQ(2u, events.size());
+  EXPECT_EQ('e', events.at(1).phase);
+  EXPECT_EQ(events.at(0).span, events.at(1).span);
+  EXPECT_TRUE(events.at(1).failed);
+  EXPECT_THROW(qilang::detail::traceCall("Traced", "throwingCall", []() -> qi::Future<int> {
+                 throw std::runtime_error("failed");
+               }), std::runtime_error);
+  EXPECT_EQ(2u, eventsOf("throwingCall").size());
+}
+
+TEST(Trace, callsMadeDuringACallAreItsChildren)
+{
+  std::uint64_t parentOfDeferred = 0;
+  qilang::detail::traceCall("Traced", "parentCall", [&] {
+    qilang::detail::traceCall("Traced", "childCall", [] { return qi::Future<int>{ 1 }; });
+    auto deferred = qilang::detail::inCurrentTraceSpan([&] { parentOfDeferred = qilang::detail::currentTraceSpan(); });
+    std::thread(deferred).join();
+    return qi::Future<int>{ 0 };
+  });
+
+  const auto parent = eventsOf("parentCall");
+  const auto child = eventsOf("childCall");
+  ASSERT_FALSE(parent.empty());
+  ASSERT_FALSE(child.empty());
+  EXPECT_EQ(parent.front().span, child.front().parent);
+  EXPECT_EQ(parent.front().span, parentOfDeferred);
+  EXPECT_EQ(0u, qilang::detail::currentTraceSpan());
+}
+
+TEST(Trace, generatedProxyAndServiceTraceTheirCalls)
+{
+  auto module = qi::import("testqilang_module");
+  TestSessionPair p;
+  testqilang::GaugePtr service = module.call<qi::AnyObject>("Gauge");
+  p.server()->registerService("Gauge", service);
+  testqilang::GaugePtr gauge = p.client()->service("Gauge").value();
+
+  const auto before = eventsOf("whatsTheTime").size();
+  gauge->whatsTheTime();
+  // the proxy and the service each record a beginning and an end, the last one maybe after the reply
+  const auto deadline = qi::SteadyClock::now() + qi::Seconds{ 5 };
+  while (eventsOf("whatsTheTime").size() < before + 4 && qi::SteadyClock::now() < deadline)
+    std::this_thread::sleep_for(qi::MilliSeconds{ 5 });
+  const auto events = eventsOf("whatsTheTime");
+  EXPECT_EQ(before + 4, events.size());
+  // the call of the service is a child of the one of the proxy, in the same trace
+  const auto isParentOf = [](const qilang::detail::TraceEvent& parent, const qilang::detail::TraceEvent& child) {
+    return parent.phase == 'b' && child.phase == 'b' && child.parent == parent.span;
+  };
+  EXPECT_TRUE(std::any_of(events.begin(), events.end(), [&](const qilang::detail::TraceEvent& child) {
+    return std::any_of(events.begin(), events.end(), [&](const qilang::detail::TraceEvent& parent) {
+      return isParentOf(parent, child);
+    });
+  }));
+  EXPECT_NE(std::string::npos, chromeTrace().find("\"name\":\"Gauge.whatsTheTime\""));
+}
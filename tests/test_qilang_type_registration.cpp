@@ -1,3 +1,4 @@
+#include <set>
 #include <gtest/gtest.h>
 #include <testqilang/somemix.hpp>
 #include <testqilang/somestructs.hpp>
@@ -17,6 +18,46 @@ TEST_F(QiLangTypeRegistration, MakeAnyObjectFromModule)
   _testqilang.call<qi::AnyObject>("AnotherInterface");
 }
 
+TEST_F(QiLangTypeRegistration, LazilyRegisteredTypeHasFullMetaObject)
+{
+  auto obj = _testqilang.call<qi::AnyObject>("KindaManager");
+  const auto& metaObject = obj.metaObject();
+  EXPECT_FALSE(metaObject.findMethod("findTruth").empty());
+  EXPECT_EQ(3u, metaObject.findMethod("overlord").size());
+  EXPECT_NE(-1, metaObject.signalId("test"));
+  EXPECT_NE(-1, metaObject.propertyId("current"));
+}
+
+TEST_F(QiLangTypeRegistration, PrecomputedSignaturesMatchTheFunctionTypes)
+{
+  auto obj = _testqilang.call<qi::AnyObject>("KindaManager");
+  const auto& metaObject = obj.metaObject();
+
+  const auto findTruth = metaObject.findMethod("findTruth");
+  ASSERT_EQ(1u, findTruth.size());
+  EXPECT_EQ("()", findTruth.front().parametersSignature().toString());
+  EXPECT_EQ("i", findTruth.front().returnSignature().toString());
+
+  const auto setOption = metaObject.findMethod("setOption");
+  ASSERT_EQ(1u, setOption.size());
+  EXPECT_EQ("(i)", setOption.front().parametersSignature().toString());
+  EXPECT_EQ("i", setOption.front().returnSignature().toString());
+
+  // Signatures depending on the C++ registration of a type are deduced by libqi.
+  const auto collect = metaObject.findMethod("collect");
+  ASSERT_EQ(1u, collect.size());
+  EXPECT_EQ("(" + qi::typeOf<std::vector<Error>>()->signature().toString() + ")",
+            collect.front().parametersSignature().toString());
+
+  std::set<std::string> overlordSignatures;
+  for (const auto& method : metaObject.findMethod("overlord"))
+  {
+    EXPECT_EQ("v", method.returnSignature().toString());
+    overlordSignatures.insert(method.parametersSignature().toString());
+  }
+  EXPECT_EQ((std::set<std::string>{ "()", "(s)", "(i)" }), overlordSignatures);
+}
+
 TEST_F(QiLangTypeRegistration, MakeChildObject)
 {
   auto obj = _testqilang.call<qi::Object<AnotherInterface>>("AnotherInterface");